@@ -8,6 +8,10 @@
 #include <unicode/ucnv.h>
 #include <unicode/coll.h>
 #include "extras.h"
+#include "OutputBuffer.h"
+#include "TopK.h"
+#include "EngineStats.h"
+#include "TrackingAllocator.h"
 
 // Estrutura de nó da árvore AVL
 template <typename T, typename Value>
@@ -22,13 +26,14 @@ struct Node
 };
 
 // Implementação da árvore AVL com balanceamento automático
-template <typename T, typename Value = int, typename COMPARATOR = comparator<T>>
+template <typename T, typename Value = int, typename COMPARATOR = comparator<T>, typename Stats = CountingStats>
 class AVLTree
 {
 private:
     Node<T, Value> *root = nullptr; // Raiz da árvore
     COMPARATOR compare;             // Função de comparação personalizada
-    unsigned int comps = 0;         // Contador de comparações
+    Stats stats;                    // Contadores de operações e comparações
+    MemoryCounter mem;              // Memória alocada pelos nós
     unsigned int _size = 0;         // Número de elementos na árvore
 
     // Função para obter a altura de um nó
@@ -78,27 +83,27 @@ private:
     {
         node->height = max(height(node->left), height(node->right)) + 1;
         int bal = balance(node);
-        comps++; // Incrementa o contador de comparações
 
         // Realiza rotações conforme o balanceamento do nó
         if (bal > 1 && balance(node->right) >= 0)
         {
+            stats.rotation(false);
             return leftRotate(node);
         }
         else if (bal > 1 && balance(node->right) < 0)
         {
-            comps++;
+            stats.rotation(true);
             node->right = rightRotate(node->right);
             return leftRotate(node);
         }
         else if (bal < -1 && balance(node->left) <= 0)
         {
-            comps += 2;
+            stats.rotation(false);
             return rightRotate(node);
         }
         else if (bal < -1 && balance(node->left) > 0)
         {
-            comps += 3;
+            stats.rotation(true);
             node->left = leftRotate(node->left);
             return rightRotate(node);
         }
@@ -114,19 +119,23 @@ private:
         // Realiza rotações conforme o balanceamento do nó
         if (bal > 1 && balance(node->right) >= 0)
         {
+            stats.rotation(false);
             return leftRotate(node);
         }
         else if (bal > 1 && balance(node->right) < 0)
         {
+            stats.rotation(true);
             node->right = rightRotate(node->right);
             return leftRotate(node);
         }
         else if (bal < -1 && balance(node->left) <= 0)
         {
+            stats.rotation(false);
             return rightRotate(node);
         }
         else if (bal < -1 && balance(node->left) > 0)
         {
+            stats.rotation(true);
             node->left = leftRotate(node->left);
             return rightRotate(node);
         }
@@ -143,7 +152,7 @@ private:
             node->key.first = successor->key.first; // Substitui a chave pelo sucessor
             node->key.second = successor->key.second;
             Node<T, Value> *aux = successor->right;
-            delete successor;
+            tracked_delete(mem, successor);
             return aux;
         }
         successor = fixupDelete(successor); // Corrige o balanceamento do sucessor
@@ -155,24 +164,35 @@ private:
     {
         if (node == nullptr)
             return node;
+        stats.visit();
+        stats.compare();
 
         // Navega pela árvore até encontrar o nó
-        if (key < node->key.first)
+        if (compare(key, node->key.first))
         {
             node->left = _delete(node->left, key);
         }
-        else if (key > node->key.first)
+        else if (compare(node->key.first, key))
         {
+            stats.compare();
             node->right = _delete(node->right, key);
         }
         else if (node->right == nullptr)
         {
+            stats.compare();
             Node<T, Value> *child = node->left;
-            delete node;
+            tracked_delete(mem, node);
+            _size--;
+            stats.remove();
             return child;
         }
         else
+        {
+            stats.compare();
             node->right = delete_successor(node, node->right);
+            _size--;
+            stats.remove();
+        }
 
         node = fixupDelete(node); // Corrige o balanceamento do nó removido
         return node;
@@ -184,9 +204,11 @@ private:
         if (node == nullptr)
         {
             _size++;
-            return new Node<T, Value>(key, value);
+            stats.insert();
+            return tracked_new<Node<T, Value>>(mem, key, value);
         }
-        comps++; // Incrementa o contador de comparações
+        stats.visit();
+        stats.compare(); // Incrementa o contador de comparações
 
         // Navega pela árvore para encontrar a posição de inserção
         if (compare(key, node->key.first))
@@ -195,12 +217,12 @@ private:
         }
         else if (compare(node->key.first, key))
         {
-            comps++;
+            stats.compare();
             node->right = _insert(node->right, key, value);
         }
         else
         {
-            comps++;
+            stats.compare();
             return node;
         }
 
@@ -215,40 +237,47 @@ private:
             return node;
 
         // Navega pela árvore para encontrar a chave
-        comps++;
+        stats.visit();
+        stats.compare();
         if (compare(key, node->key.first))
         {
             node->left = _update(node->left, key, value);
         }
         else if (compare(node->key.first, key))
         {
-            comps++;
+            stats.compare();
             node->right = _update(node->right, key, value);
         }
         else
         {
-            comps++;
+            stats.compare();
+            stats.update();
             node->key.second = value; // Atualiza a frequência
         }
         return node;
     }
 
-    // Função recursiva para imprimir a árvore em ordem (in-order)
-    void _print(Node<T, Value> *node) const
+    // Função recursiva que percorre a árvore em ordem (in-order), chamando fn(chave, valor)
+    template <typename F>
+    void _for_each(Node<T, Value> *node, F &fn) const
     {
         if (node == nullptr)
             return;
 
-        _print(node->left); // Imprime a subárvore esquerda
-        if constexpr (std::is_same<T, icu::UnicodeString>::value)
-        {
-            std::string skey;
-            node->key.first.toUTF8String(skey);
-            std::cout << skey << ": " << node->key.second << std::endl;
-        }
-        else
-            std::cout << node->key.first << ": " << node->key.second << std::endl;
-        _print(node->right); // Imprime a subárvore direita
+        _for_each(node->left, fn); // Percorre a subárvore esquerda
+        fn(node->key.first, node->key.second);
+        _for_each(node->right, fn); // Percorre a subárvore direita
+    }
+
+    // Função recursiva que oferece todos os nós da subárvore à seleção das mais frequentes
+    void _top_k(Node<T, Value> *node, TopK<T, Value, COMPARATOR> &top) const
+    {
+        if (node == nullptr)
+            return;
+
+        _top_k(node->left, top);
+        top.offer(node->key.first, node->key.second);
+        _top_k(node->right, top);
     }
 
     // Função para imprimir a árvore visualmente
@@ -296,7 +325,7 @@ private:
         _clear(node->right);
 
         // Depois de limpar as subárvores, delete o nó atual
-        delete node;
+        tracked_delete(mem, node);
     }
 
     // Função auxiliar para verificar se a árvore contém uma chave
@@ -304,7 +333,8 @@ private:
     {
         if (node == nullptr)
             return false; // Se o nó é nulo, a chave não está na árvore
-        comps++;
+        stats.visit();
+        stats.compare();
         if (compare(key, node->key.first))
         {
             return _contains(node->left, key); // Procura na subárvore esquerda se a chave é menor que a chave do nó atual
@@ -312,12 +342,12 @@ private:
 
         else if (compare(node->key.first, key))
         {
-            comps++;
+            stats.compare();
             return _contains(node->right, key); // Procura na subárvore direita se a chave é maior que a chave do nó atual
         }
         else
         {
-            comps++;
+            stats.compare();
             return true; // A chave foi encontrada
         }
     }
@@ -330,46 +360,63 @@ public:
         _size = 0;
     }
 
+    // Destrutor da árvore (libera todos os nós)
+    ~AVLTree()
+    {
+        clear();
+    }
+
+    // Desabilita a cópia da árvore
+    AVLTree(const AVLTree &t) = delete;
+    AVLTree &operator=(const AVLTree &t) = delete;
+
     // Função para inserir uma chave na árvore
     void insert(T key, Value value)
     {
         root = _insert(root, key, value);
+        stats.end_search();
     }
 
     // Função para remover uma chave da árvore
     void remove(T key)
     {
         root = _delete(root, key);
+        stats.end_search();
     }
 
     // Função para atualizar a frequência de uma chave
     void update(T key, Value value)
     {
         root = _update(root, key, value);
+        stats.end_search();
     }
 
     // Função para buscar uma chave na árvore
     Value find(T key)
     {
+        stats.lookup();
         Node<T, Value> *node = root;
         while (node != nullptr)
         {
-            comps++;
+            stats.visit();
+            stats.compare();
             if (compare(key, node->key.first))
             {
                 node = node->left;
             }
             else if (compare(node->key.first, key))
             {
-                comps++;
+                stats.compare();
                 node = node->right;
             }
             else
             {
-                comps++;
+                stats.compare();
+                stats.end_search();
                 return node->key.second;
             }
         }
+        stats.end_search();
         return Value(); // Retorna um objeto default se não encontrar a chave
     }
 
@@ -377,32 +424,59 @@ public:
     // Operador de índice const para acessar elementos na tabela
     Value &operator[](const T &key)
     {
+        stats.lookup();
         Node<T, Value> *node = root;
         while (node != nullptr)
         {
-            comps++;
+            stats.visit();
+            stats.compare();
             if (compare(key, node->key.first))
             {
                 node = node->left;
             }
             else if (compare(node->key.first, key))
             {
-                comps++;
+                stats.compare();
                 node = node->right;
             }
             else
             {
-                comps++;
+                stats.compare();
+                stats.end_search();
                 return node->key.second;
             }
         }
+        stats.end_search();
         throw std::out_of_range("Key not found"); // Lança exceção se a chave não for encontrada
     }
 
     // Função para imprimir a árvore
     void print() const
     {
-        _print(root);
+        OutputBuffer out;
+        print(out);
+    }
+
+    // Função para imprimir a árvore em um buffer de saída
+    void print(OutputBuffer &out) const
+    {
+        for_each([&out](const T &key, const Value &value)
+                 { out.entry(key, value); });
+    }
+
+    // Chama fn(chave, valor) para cada elemento, em ordem (a mesma da lista impressa)
+    template <typename F>
+    void for_each(F fn) const
+    {
+        _for_each(root, fn);
+    }
+
+    // Função que retorna as k chaves de maior valor, da maior para a menor
+    std::vector<std::pair<T, Value>> top_k(size_t k) const
+    {
+        TopK<T, Value, COMPARATOR> top(k, compare);
+        _top_k(root, top);
+        return top.result();
     }
 
     // Função para limpar a árvore
@@ -417,13 +491,32 @@ public:
     // Função que verifica se a árvore contém uma chave
     bool contains(const T &key)
     {
-        return _contains(root, key); // Inicia a busca a partir da raiz
+        stats.lookup();
+        bool found = _contains(root, key); // Inicia a busca a partir da raiz
+        stats.end_search();
+        return found;
     }
 
     // Função para retornar o número de comparações feitas
     size_t comparisons()
     {
-        return comps;
+        return stats.comparisons();
+    }
+
+    // Função que retorna as estatísticas da árvore (contadores e altura atual)
+    EngineStats statistics() const
+    {
+        EngineStats s = stats.counters();
+        s.layout = EngineLayout::Tree;
+        s.height = root == nullptr ? 0 : root->height;
+        s.size = _size;
+        return s;
+    }
+
+    // Função que retorna a memória ocupada pelos nós (estrutura, chaves e valores)
+    MemoryUsage memory() const
+    {
+        return mem.usage(_size, sizeof(T), sizeof(Value));
     }
 
     // Função para retornar o número de elementos na árvore
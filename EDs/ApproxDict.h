@@ -0,0 +1,323 @@
+#ifndef APPROXDICT_H
+#define APPROXDICT_H
+
+#include <iostream>
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <unicode/unistr.h>
+#include "extras.h"
+#include "OutputBuffer.h"
+#include "TopK.h"
+#include "CollationSort.h"
+#include "HyperLogLog.h"
+
+// Sketch Count-Min com atualização conservadora
+// Uma matriz depth x width de contadores; cada palavra soma em um contador por linha e a estimativa
+// é o menor deles. Com width = ceil(e / eps) e depth = ceil(ln(1 / delta)), a estimativa nunca é
+// menor que a frequência real e passa dela em no máximo eps * N (N = total de ocorrências) com
+// probabilidade de pelo menos 1 - delta. A atualização conservadora só aumenta os contadores que
+// ficariam abaixo da nova estimativa, o que reduz o erro sem perder essas garantias
+class CountMinSketch
+{
+private:
+    size_t m_width;                 // Contadores por linha
+    size_t m_depth;                 // Número de linhas (funções de hash)
+    std::vector<uint64_t> m_counts; // Contadores (linha a linha; 64 bits, como o total de ocorrências)
+
+    // Posição da palavra na linha row (hash duplo a partir de um único hash de 64 bits)
+    size_t slot(uint64_t hash, size_t row) const
+    {
+        uint32_t h = static_cast<uint32_t>(hash) + static_cast<uint32_t>(row) * (static_cast<uint32_t>(hash >> 32) | 1);
+        return row * m_width + static_cast<size_t>((static_cast<uint64_t>(h) * m_width) >> 32);
+    }
+
+public:
+    CountMinSketch(double eps, double delta)
+    {
+        m_width = static_cast<size_t>(std::ceil(std::exp(1.0) / eps));
+        m_depth = static_cast<size_t>(std::ceil(std::log(1.0 / delta)));
+        if (m_depth == 0)
+            m_depth = 1;
+        m_counts.assign(m_width * m_depth, 0);
+    }
+
+    // Soma value à palavra e retorna a nova estimativa
+    uint64_t add(uint64_t hash, uint32_t value)
+    {
+        uint64_t estimate = find(hash) + value;
+        for (size_t row = 0; row < m_depth; row++)
+        {
+            uint64_t &counter = m_counts[slot(hash, row)];
+            if (counter < estimate)
+                counter = estimate;
+        }
+        return estimate;
+    }
+
+    // Estimativa da frequência (nunca menor que a real)
+    uint64_t find(uint64_t hash) const
+    {
+        uint64_t estimate = UINT64_MAX;
+        for (size_t row = 0; row < m_depth; row++)
+        {
+            uint64_t counter = m_counts[slot(hash, row)];
+            if (counter < estimate)
+                estimate = counter;
+        }
+        return estimate;
+    }
+
+    void clear()
+    {
+        std::fill(m_counts.begin(), m_counts.end(), 0);
+    }
+
+    size_t width() const { return m_width; }
+    size_t depth() const { return m_depth; }
+
+    // Memória dos contadores, em bytes
+    size_t bytes() const
+    {
+        return m_counts.size() * sizeof(uint64_t);
+    }
+};
+
+// Dicionário aproximado de memória limitada
+// As frequências ficam em um sketch Count-Min (tamanho fixo, definido por eps e delta) e as
+// palavras mais frequentes ficam em uma tabela exata de tamanho fixo (algoritmo Space-Saving):
+// toda palavra com frequência maior que N / capacity está na tabela. A memória não depende do
+// tamanho do vocabulário, então as palavras fora da tabela não podem ser listadas, só consultadas,
+// e o número de palavras distintas vem de um HyperLogLog.
+// Expõe as mesmas operações de leitura e soma de Dict (sem remove e update, que o sketch não suporta)
+template <typename COMPARATOR = comparator<std::string>>
+class ApproxDict
+{
+private:
+    // Palavra monitorada pelo Space-Saving
+    struct Monitored
+    {
+        std::string word; // Palavra
+        uint64_t count;   // Frequência estimada (nunca menor que a real)
+        uint64_t error;   // Quanto da frequência pode ter sido superestimado ao entrar na tabela
+    };
+
+    double m_eps;                                   // Erro relativo ao total de ocorrências
+    double m_delta;                                 // Probabilidade de o erro passar de eps * N
+    size_t m_capacity;                              // Número de palavras monitoradas
+    CountMinSketch m_sketch;                        // Frequências de todas as palavras
+    HyperLogLog m_distinct;                         // Número de palavras distintas
+    std::vector<Monitored> m_heap;                  // Palavras monitoradas (heap de mínimo pela frequência)
+    std::unordered_map<std::string, size_t> m_pos;  // Posição de cada palavra monitorada no heap
+    uint64_t m_total = 0;                           // Total de ocorrências (N)
+    size_t comps = 0;                               // Contador de comparações (entre frequências, no heap)
+    COMPARATOR compare;                             // Comparador da ordem das palavras (criado uma única vez)
+
+    // Converte a palavra para UTF-8
+    static std::string_view utf8(const std::string &word, std::string &)
+    {
+        return word;
+    }
+
+    static std::string_view utf8(const icu::UnicodeString &word, std::string &scratch)
+    {
+        scratch.clear();
+        word.toUTF8String(scratch);
+        return scratch;
+    }
+
+    // Desce o elemento da posição i no heap até que nenhum filho tenha frequência menor
+    void siftDown(size_t i)
+    {
+        size_t n = m_heap.size();
+        while (true)
+        {
+            size_t smallest = i;
+            size_t l = 2 * i + 1;
+            size_t r = l + 1;
+            if (l < n && (comps++, m_heap[l].count < m_heap[smallest].count))
+                smallest = l;
+            if (r < n && (comps++, m_heap[r].count < m_heap[smallest].count))
+                smallest = r;
+            if (smallest == i)
+                return;
+            std::swap(m_heap[i], m_heap[smallest]);
+            m_pos[m_heap[i].word] = i;
+            m_pos[m_heap[smallest].word] = smallest;
+            i = smallest;
+        }
+    }
+
+    // Sobe o elemento da posição i no heap enquanto ele tiver frequência menor que o pai
+    void siftUp(size_t i)
+    {
+        while (i > 0)
+        {
+            size_t parent = (i - 1) / 2;
+            comps++;
+            if (!(m_heap[i].count < m_heap[parent].count))
+                return;
+            std::swap(m_heap[i], m_heap[parent]);
+            m_pos[m_heap[i].word] = i;
+            m_pos[m_heap[parent].word] = parent;
+            i = parent;
+        }
+    }
+
+    // Frequência estimada de uma palavra monitorada (a menor das duas estimativas)
+    uint64_t estimate(const Monitored &m) const
+    {
+        uint64_t cms = m_sketch.find(hash64(m.word));
+        return (cms < m.count) ? cms : m.count;
+    }
+
+public:
+    // eps: erro máximo relativo ao total de ocorrências; delta: probabilidade de passar desse erro;
+    // capacity: número de palavras frequentes guardadas de forma exata
+    ApproxDict(double eps = 1e-4, double delta = 0.01, size_t capacity = 1000, COMPARATOR comp = COMPARATOR())
+        : m_eps(eps), m_delta(delta), m_capacity(capacity), m_sketch(eps, delta), compare(comp)
+    {
+        m_heap.reserve(capacity);
+        m_pos.reserve(capacity);
+    }
+
+    // Soma value à frequência da palavra (icu::UnicodeString ou texto UTF-8)
+    template <typename Word>
+    void add(const Word &word, unsigned int value = 1)
+    {
+        std::string scratch;
+        std::string_view w = utf8(word, scratch);
+        m_total += value;
+        uint64_t h = hash64(w);
+        uint64_t cms = m_sketch.add(h, value);
+        m_distinct.add_hash(h);
+        if (m_capacity == 0)
+            return;
+
+        auto it = m_pos.find(std::string(w));
+        if (it != m_pos.end())
+        {
+            Monitored &m = m_heap[it->second];
+            m.count = (cms < m.count + value) ? cms : m.count + value;
+            siftDown(it->second);
+        }
+        else if (m_heap.size() < m_capacity)
+        {
+            m_heap.push_back({std::string(w), value, 0});
+            m_pos[m_heap.back().word] = m_heap.size() - 1;
+            siftUp(m_heap.size() - 1);
+        }
+        else
+        {
+            // Substitui a palavra monitorada menos frequente (Space-Saving)
+            // A palavra entra com a estimativa do sketch, que já inclui esta ocorrência e nunca é menor que a real
+            Monitored &min = m_heap.front();
+            m_pos.erase(min.word);
+            min.error = cms - value;
+            min.count = cms;
+            min.word = std::string(w);
+            m_pos[min.word] = 0;
+            siftDown(0);
+        }
+    }
+
+    // Frequência estimada da palavra (nunca menor que a real; 0 só se ela nunca apareceu)
+    template <typename Word>
+    int find(const Word &word)
+    {
+        std::string scratch;
+        std::string_view w = utf8(word, scratch);
+        uint64_t est = m_sketch.find(hash64(w));
+        auto it = m_pos.find(std::string(w));
+        if (it != m_pos.end() && m_heap[it->second].count < est)
+            est = m_heap[it->second].count;
+        return static_cast<int>(std::min<uint64_t>(est, INT_MAX));
+    }
+
+    // Verifica se a palavra (provavelmente) apareceu; pode dar falso positivo, nunca falso negativo
+    template <typename Word>
+    bool contains(const Word &word)
+    {
+        return find(word) > 0;
+    }
+
+    // Retorna as k palavras mais frequentes entre as monitoradas, da mais frequente para a menos frequente
+    // O resultado é exato para as palavras com frequência maior que N / capacity
+    std::vector<std::pair<std::string, uint64_t>> top_k(size_t k) const
+    {
+        TopK<std::string, uint64_t, COMPARATOR> top(k, compare);
+        for (const Monitored &m : m_heap)
+            top.offer(m.word, estimate(m));
+        return top.result();
+    }
+
+    void clear()
+    {
+        m_sketch.clear();
+        m_distinct.clear();
+        m_heap.clear();
+        m_pos.clear();
+        m_total = 0;
+    }
+
+    // Número estimado de palavras distintas
+    size_t size() const
+    {
+        return m_distinct.estimate();
+    }
+
+    size_t comparisons() const
+    {
+        return comps;
+    }
+
+    // Total de ocorrências somadas (N)
+    uint64_t total() const
+    {
+        return m_total;
+    }
+
+    double epsilon() const { return m_eps; }
+    double delta() const { return m_delta; }
+
+    // Erro máximo das frequências estimadas (eps * N), válido com probabilidade 1 - delta
+    uint64_t error_bound() const
+    {
+        return static_cast<uint64_t>(std::ceil(m_eps * m_total));
+    }
+
+    // Memória do sketch e da tabela de palavras monitoradas, em bytes (aproximada)
+    size_t bytes() const
+    {
+        size_t n = m_sketch.bytes() + m_distinct.bytes() + m_heap.capacity() * sizeof(Monitored);
+        for (const Monitored &m : m_heap)
+            n += 2 * (m.word.capacity() + 1) + sizeof(std::pair<std::string, size_t>) + 2 * sizeof(void *);
+        return n;
+    }
+
+    // Imprime as palavras monitoradas em ordem com as suas frequências estimadas
+    void print()
+    {
+        OutputBuffer out;
+        print(out);
+    }
+
+    // Imprime as palavras monitoradas em ordem com as suas frequências estimadas em um buffer de saída
+    void print(OutputBuffer &out)
+    {
+        std::vector<uint32_t> order = collation_order(m_heap.size(), [this](size_t i) -> const std::string &
+                                                      { return m_heap[i].word; }, compare);
+        for (uint32_t i : order)
+        {
+            out.entry(m_heap[i].word, estimate(m_heap[i]));
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,142 @@
+#ifndef BLOOMFILTER_H
+#define BLOOMFILTER_H
+
+#include <iostream>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+#include "extras.h"
+
+// Filtro de Bloom em blocos, para responder "certamente ausente" sem consultar o dicionário
+// Cada palavra usa um único bloco de 64 bytes (uma linha de cache), escolhido pelo hash64 dela, e liga
+// k bits dentro dele; então uma consulta lê uma linha de cache, não importa k. O preço dos blocos é uma
+// taxa de falso positivo um pouco maior que a do filtro comum com a mesma memória (os blocos não
+// recebem exatamente o mesmo número de palavras), compensada com ~20% de bits a mais no dimensionamento.
+// Não há remoção: uma palavra removida do dicionário continua no filtro (vira um falso positivo)
+class BloomFilter
+{
+private:
+    static const size_t BLOCK_BITS = 512; // Bits de cada bloco (64 bytes)
+
+    struct alignas(64) Block
+    {
+        uint64_t words[BLOCK_BITS / 64] = {};
+    };
+
+    std::vector<Block> m_blocks;
+    unsigned int m_hashes; // Bits ligados por palavra (k)
+    size_t m_capacity;     // Número de palavras para o qual o filtro foi dimensionado
+    double m_target;       // Taxa de falso positivo desejada com m_capacity palavras
+
+    // Mistura o hash de novo (os bits do bloco não podem depender dos que escolheram o bloco)
+    static uint64_t remix(uint64_t h)
+    {
+        h ^= h >> 31;
+        h *= 0x9e3779b97f4a7c15ull;
+        h ^= h >> 29;
+        return h;
+    }
+
+    // Bloco da palavra: os bits altos do hash multiplicados pelo número de blocos (sem divisão)
+    size_t block_of(uint64_t h) const
+    {
+        return static_cast<size_t>((static_cast<unsigned __int128>(h) * m_blocks.size()) >> 64);
+    }
+
+public:
+    // Dimensiona o filtro para capacity palavras com taxa de falso positivo fpr (entre 0 e 1)
+    // Bits por palavra: -ln(fpr) / ln(2)^2 (mais a folga dos blocos); k = bits por palavra * ln(2)
+    BloomFilter(size_t capacity = 1024, double fpr = 0.01) : m_capacity(capacity), m_target(fpr)
+    {
+        if (!(fpr > 0 && fpr < 1))
+            throw std::out_of_range("out of range false positive rate");
+        if (m_capacity == 0)
+            m_capacity = 1;
+        double bits = -std::log(fpr) / (std::log(2.0) * std::log(2.0));
+        m_hashes = static_cast<unsigned int>(std::lround(bits * std::log(2.0)));
+        m_hashes = m_hashes < 1 ? 1 : (m_hashes > 16 ? 16 : m_hashes);
+        size_t total = static_cast<size_t>(std::ceil(1.2 * bits * m_capacity));
+        m_blocks.resize((total + BLOCK_BITS - 1) / BLOCK_BITS);
+    }
+
+    // Adiciona uma palavra UTF-8
+    void add(std::string_view word)
+    {
+        add_hash(hash64(word));
+    }
+
+    // Adiciona uma palavra pelo seu hash64 (quando ele já foi calculado)
+    void add_hash(uint64_t h)
+    {
+        Block &block = m_blocks[block_of(h)];
+        uint64_t g = remix(h);
+        uint32_t a = static_cast<uint32_t>(g), b = static_cast<uint32_t>(g >> 32) | 1;
+        for (unsigned int i = 0; i < m_hashes; i++)
+        {
+            uint32_t bit = (a + i * b) >> 23; // 9 bits: posição dentro do bloco
+            block.words[bit / 64] |= uint64_t(1) << (bit % 64);
+        }
+    }
+
+    // Retorna false se a palavra certamente não foi adicionada (true pode ser um falso positivo)
+    bool contains(std::string_view word) const
+    {
+        return contains_hash(hash64(word));
+    }
+
+    bool contains_hash(uint64_t h) const
+    {
+        const Block &block = m_blocks[block_of(h)];
+        uint64_t g = remix(h);
+        uint32_t a = static_cast<uint32_t>(g), b = static_cast<uint32_t>(g >> 32) | 1;
+        bool found = true;
+        for (unsigned int i = 0; i < m_hashes; i++)
+        {
+            uint32_t bit = (a + i * b) >> 23;
+            found &= (block.words[bit / 64] >> (bit % 64)) & 1; // Sem desvio por bit
+        }
+        return found;
+    }
+
+    // Desliga todos os bits (mantém o dimensionamento)
+    void clear()
+    {
+        for (Block &block : m_blocks)
+            block = Block();
+    }
+
+    size_t capacity() const { return m_capacity; }
+    double target() const { return m_target; }
+    unsigned int hashes() const { return m_hashes; }
+
+    // Memória dos blocos, em bytes
+    size_t bytes() const
+    {
+        return m_blocks.size() * sizeof(Block);
+    }
+
+    // Bits por palavra da capacidade
+    double bits_per_key() const
+    {
+        return 8.0 * bytes() / m_capacity;
+    }
+
+    // Taxa de falso positivo estimada pelo preenchimento atual: média, entre os blocos, da
+    // probabilidade de os k bits de uma palavra ausente já estarem ligados ((bits ligados / 512)^k)
+    double false_positive_rate() const
+    {
+        double sum = 0;
+        for (const Block &block : m_blocks)
+        {
+            size_t set = 0;
+            for (uint64_t w : block.words)
+                set += static_cast<size_t>(__builtin_popcountll(w));
+            sum += std::pow(static_cast<double>(set) / BLOCK_BITS, m_hashes);
+        }
+        return m_blocks.empty() ? 0.0 : sum / m_blocks.size();
+    }
+};
+
+#endif
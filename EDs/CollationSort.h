@@ -0,0 +1,141 @@
+#ifndef COLLATIONSORT_H
+#define COLLATIONSORT_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include <unicode/unistr.h>
+#include <unicode/coll.h>
+#include "extras.h"
+
+// Número mínimo de chaves por thread na ordenação paralela (abaixo disso, criar threads não compensa)
+const size_t COLLATION_SORT_GRAIN = 4096;
+
+// Converte uma chave para icu::UnicodeString (necessário para gerar a chave de ordenação do ICU)
+inline const icu::UnicodeString &to_unicode(const icu::UnicodeString &key, icu::UnicodeString &)
+{
+    return key;
+}
+
+inline const icu::UnicodeString &to_unicode(const WordRef &key, icu::UnicodeString &scratch)
+{
+    scratch = icu::UnicodeString::fromUTF8(icu::StringPiece(key.data(), key.length()));
+    return scratch;
+}
+
+inline const icu::UnicodeString &to_unicode(const std::string &key, icu::UnicodeString &scratch)
+{
+    scratch = icu::UnicodeString::fromUTF8(icu::StringPiece(key.data(), key.size()));
+    return scratch;
+}
+
+// Executa fn(t, begin, end) para cada um dos pedaços [begin, end) de [0, n), um por thread
+template <typename F>
+void parallel_chunks(size_t n, unsigned int threads, F fn)
+{
+    if (threads <= 1)
+    {
+        fn(0, 0, n);
+        return;
+    }
+    std::vector<std::thread> workers;
+    for (unsigned int t = 0; t < threads; t++)
+        workers.emplace_back(fn, t, n * t / threads, n * (t + 1) / threads);
+    for (auto &w : workers)
+        w.join();
+}
+
+// Ordena os índices [0, n) pela ordem das chaves (key(i) retorna a i-ésima chave)
+// Com u_comparator, cada chave é convertida uma única vez em uma chave de ordenação do ICU (bytes
+// comparáveis com strcmp, na mesma ordem do Collator), em paralelo e com um Collator clonado por
+// thread; os índices são então ordenados por merge sort paralelo sem chamar o Collator.
+// Com outros comparadores, ordena os índices com std::sort e o próprio comparador
+template <typename KeyAt, typename COMPARATOR>
+std::vector<uint32_t> collation_order(size_t n, KeyAt key, const COMPARATOR &compare,
+                                      unsigned int threads = std::thread::hardware_concurrency())
+{
+    std::vector<uint32_t> order(n);
+    for (size_t i = 0; i < n; i++)
+        order[i] = static_cast<uint32_t>(i);
+
+    if constexpr (!std::is_same<COMPARATOR, u_comparator>::value)
+    {
+        std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b)
+                  { return compare(key(a), key(b)); });
+        return order;
+    }
+    else
+    {
+        threads = std::max(1u, std::min<unsigned int>(threads, static_cast<unsigned int>(n / COLLATION_SORT_GRAIN)));
+
+        // Gera as chaves de ordenação: cada thread usa o próprio Collator e o próprio bloco de bytes
+        std::vector<std::vector<char>> blobs(threads);
+        std::vector<size_t> offsets(n);
+        parallel_chunks(n, threads, [&](unsigned int t, size_t begin, size_t end)
+                        {
+            std::unique_ptr<icu::Collator> collator(compare.collator->clone());
+            std::vector<char> &blob = blobs[t];
+            icu::UnicodeString scratch;
+            for (size_t i = begin; i < end; i++)
+            {
+                const icu::UnicodeString &text = to_unicode(key(i), scratch);
+                size_t at = blob.size();
+                blob.resize(at + 4 * text.length() + 16);
+                int32_t len = collator->getSortKey(text, reinterpret_cast<uint8_t *>(blob.data() + at), static_cast<int32_t>(blob.size() - at));
+                if (static_cast<size_t>(len) > blob.size() - at)
+                {
+                    blob.resize(at + len);
+                    collator->getSortKey(text, reinterpret_cast<uint8_t *>(blob.data() + at), len);
+                }
+                blob.resize(at + len);
+                offsets[i] = at;
+            } });
+
+        // Converte os deslocamentos em ponteiros (os blocos não mudam mais de tamanho)
+        std::vector<const char *> sortkeys(n);
+        parallel_chunks(n, threads, [&](unsigned int t, size_t begin, size_t end)
+                        {
+            for (size_t i = begin; i < end; i++)
+                sortkeys[i] = blobs[t].data() + offsets[i]; });
+
+        auto less = [&](uint32_t a, uint32_t b)
+        { return std::strcmp(sortkeys[a], sortkeys[b]) < 0; };
+
+        // Ordena cada pedaço em uma thread e intercala os pedaços dois a dois, também em paralelo
+        std::vector<size_t> bounds(threads + 1);
+        for (unsigned int t = 0; t <= threads; t++)
+            bounds[t] = n * t / threads;
+        parallel_chunks(n, threads, [&](unsigned int, size_t begin, size_t end)
+                        { std::sort(order.begin() + begin, order.begin() + end, less); });
+
+        std::vector<uint32_t> merged(n);
+        while (bounds.size() > 2)
+        {
+            std::vector<size_t> next;
+            std::vector<std::thread> workers;
+            for (size_t c = 0; c + 1 < bounds.size(); c += 2)
+            {
+                size_t lo = bounds[c];
+                size_t mid = bounds[c + 1];
+                size_t hi = (c + 2 < bounds.size()) ? bounds[c + 2] : mid;
+                next.push_back(lo);
+                workers.emplace_back([&, lo, mid, hi]()
+                                     { std::merge(order.begin() + lo, order.begin() + mid, order.begin() + mid, order.begin() + hi,
+                                                  merged.begin() + lo, less); });
+            }
+            next.push_back(n);
+            for (auto &w : workers)
+                w.join();
+            order.swap(merged);
+            bounds = next;
+        }
+        return order;
+    }
+}
+
+#endif
@@ -1,63 +1,435 @@
 #ifndef DICT_H
 #define DICT_H
 
+#include <algorithm>
 #include <iostream>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
 #include "AVLTree.h"
 #include "RBTree.h"
 #include "Hash.h"
 #include "Hash2.h"
+#include "Treap.h"
+#include "SkipList.h"
+#include "PersistentAVLTree.h"
+#include "FrozenDict.h"
+#include "BloomFilter.h"
+
+// Obtém o tipo da chave de uma estrutura (o primeiro parâmetro do template)
+template <typename EDType>
+struct key_of;
+
+template <template <typename...> class EDTemplate, typename Key, typename... Rest>
+struct key_of<EDTemplate<Key, Rest...>>
+{
+    typedef Key type;
+};
+
+// Obtém o tipo do comparador de uma estrutura (o terceiro parâmetro do template)
+template <typename EDType>
+struct comparator_of;
+
+template <template <typename...> class EDTemplate, typename Key, typename Value, typename COMPARATOR, typename... Rest>
+struct comparator_of<EDTemplate<Key, Value, COMPARATOR, Rest...>>
+{
+    typedef COMPARATOR type;
+};
+
+// Verifica em tempo de compilação se a estrutura implementa a própria operação de soma (add),
+// como as estruturas concorrentes, em que buscar e depois inserir não seria atômico
+template <typename EDType, typename = void>
+struct has_add : std::false_type
+{
+};
+
+template <typename EDType>
+struct has_add<EDType, std::void_t<decltype(std::declval<EDType &>().add(std::declval<typename key_of<EDType>::type>(), 1))>> : std::true_type
+{
+};
+
+// Verifica em tempo de compilação se a estrutura pode ser pré-dimensionada (reserve), como as tabelas de hash
+template <typename EDType, typename = void>
+struct has_reserve : std::false_type
+{
+};
+
+template <typename EDType>
+struct has_reserve<EDType, std::void_t<decltype(std::declval<EDType &>().reserve(size_t(0)))>> : std::true_type
+{
+};
+
+// Verifica em tempo de compilação se a estrutura expõe estatísticas estruturais (statistics)
+template <typename EDType, typename = void>
+struct has_statistics : std::false_type
+{
+};
+
+template <typename EDType>
+struct has_statistics<EDType, std::void_t<decltype(std::declval<const EDType &>().statistics())>> : std::true_type
+{
+};
+
+// Verifica em tempo de compilação se a estrutura informa a memória ocupada (memory)
+template <typename EDType, typename = void>
+struct has_memory : std::false_type
+{
+};
+
+template <typename EDType>
+struct has_memory<EDType, std::void_t<decltype(std::declval<const EDType &>().memory())>> : std::true_type
+{
+};
+
+// Verifica em tempo de compilação se a estrutura (ou o dicionário) tira snapshots de si mesma (snapshot)
+template <typename EDType, typename = void>
+struct has_snapshot : std::false_type
+{
+};
+
+template <typename EDType>
+struct has_snapshot<EDType, std::void_t<decltype(std::declval<const EDType &>().snapshot())>> : std::true_type
+{
+};
+
+// Verifica em tempo de compilação se o dicionário pode ser convertido para FrozenDict (freeze)
+template <typename D, typename = void>
+struct has_freeze : std::false_type
+{
+};
+
+template <typename D>
+struct has_freeze<D, std::void_t<decltype(std::declval<D &>().freeze())>> : std::true_type
+{
+};
+
+// Verifica em tempo de compilação se o dicionário aceita um filtro de Bloom na frente das buscas (bloom)
+template <typename D, typename = void>
+struct has_bloom : std::false_type
+{
+};
+
+template <typename D>
+struct has_bloom<D, std::void_t<decltype(std::declval<const D &>().bloom_filter())>> : std::true_type
+{
+};
+
+// Verifica em tempo de compilação se a estrutura busca várias chaves do tipo K de uma vez (find_batch)
+template <typename EDType, typename K, typename = void>
+struct has_find_batch : std::false_type
+{
+};
+
+template <typename EDType, typename K>
+struct has_find_batch<EDType, K, std::void_t<decltype(std::declval<EDType &>().find_batch(std::declval<const K *>(), size_t(0), std::declval<int *>()))>> : std::true_type
+{
+};
+
+// Hash64 dos bytes UTF-8 de uma palavra (usado pelo filtro de Bloom)
+template <typename Word>
+uint64_t word_hash(const Word &word)
+{
+    if constexpr (std::is_same<Word, icu::UnicodeString>::value)
+    {
+        std::string utf8;
+        word.toUTF8String(utf8);
+        return hash64(utf8);
+    }
+    else
+        return hash64(std::string_view(word));
+}
+
+// Texto UTF-8 de uma chave
+template <typename Key>
+std::string key_text(const Key &key)
+{
+    if constexpr (std::is_same<Key, WordRef>::value)
+        return std::string(key.view());
+    else
+    {
+        std::string utf8;
+        key.toUTF8String(utf8);
+        return utf8;
+    }
+}
+
+// Converte uma palavra UTF-8 para a chave de uma estrutura, internando-a na arena se a chave for WordRef
+// Com intern = false, uma palavra nunca internada vira uma WordRef vazia (nenhuma estrutura a contém)
+template <typename Key>
+Key make_key(KeyArena &arena, std::string_view word, bool intern)
+{
+    if constexpr (std::is_same<Key, WordRef>::value)
+        return intern ? arena.intern(word) : arena.lookup(word);
+    else
+        return icu::UnicodeString::fromUTF8(icu::StringPiece(word.data(), word.size()));
+}
+
+// Converte uma icu::UnicodeString para a chave de uma estrutura
+template <typename Key>
+Key make_key(KeyArena &arena, const icu::UnicodeString &word, bool intern)
+{
+    if constexpr (std::is_same<Key, WordRef>::value)
+    {
+        std::string utf8;
+        word.toUTF8String(utf8);
+        return make_key<Key>(arena, std::string_view(utf8), intern);
+    }
+    else
+        return word;
+}
+
+// Verifica se a chave certamente não está em nenhuma estrutura (palavra nunca internada)
+template <typename Key>
+bool missing_key(const Key &key)
+{
+    if constexpr (std::is_same<Key, WordRef>::value)
+        return key.null();
+    else
+        return false;
+}
+
+// Versão imutável devolvida por Dict::snapshot(): a versão da estrutura mais uma referência à arena das
+// palavras, que continua viva enquanto a versão existir (mesmo depois de clear ou da destruição do Dict)
+template <typename Version>
+class DictSnapshot : public Version
+{
+private:
+    std::shared_ptr<const KeyArena> m_arena;
+
+public:
+    DictSnapshot(Version version, std::shared_ptr<const KeyArena> arena)
+        : Version(std::move(version)), m_arena(std::move(arena))
+    {
+    }
+};
 
 template <typename EDType>
 class Dict
 {
 private:
+    typedef typename key_of<EDType>::type Key;
+
+    // Arena das palavras (usada apenas quando a estrutura guarda WordRef); compartilhada com os snapshots
+    std::shared_ptr<KeyArena> _arena = std::make_shared<KeyArena>();
     EDType _dict;
+    std::unique_ptr<BloomFilter> _bloom; // Filtro na frente das buscas (nulo se desligado)
+    size_t _bloom_rejected = 0;          // Buscas respondidas pelo filtro sem consultar a estrutura
+
+    // Converte a palavra para a chave da estrutura
+    template <typename Word>
+    Key _key(const Word &word, bool intern)
+    {
+        return make_key<Key>(*_arena, word, intern);
+    }
+
+    // Verifica pelo filtro de Bloom se a palavra certamente não está no dicionário (false sem filtro)
+    template <typename Word>
+    bool _rejected(const Word &word)
+    {
+        if (!_bloom || _bloom->contains_hash(word_hash(word)))
+            return false;
+        _bloom_rejected++;
+        return true;
+    }
+
+    // Refaz o filtro de Bloom para capacity palavras e taxa de falso positivo fpr, com as palavras atuais
+    // As palavras vêm da arena (palavras removidas também, o que só acrescenta falsos positivos)
+    void _rebuild_bloom(size_t capacity, double fpr)
+    {
+        std::unique_ptr<BloomFilter> bloom(new BloomFilter(capacity, fpr));
+        if constexpr (std::is_same<Key, WordRef>::value)
+            _arena->for_each([&bloom](WordRef w)
+                            { bloom->add(w.view()); });
+        else
+            _dict.for_each([&bloom](const Key &key, const auto &)
+                           { bloom->add_hash(word_hash(key)); });
+        _bloom = std::move(bloom);
+    }
 
 public:
-    void add(icu::UnicodeString key, unsigned int value = 1)
+    // As operações aceitam a palavra como icu::UnicodeString ou como texto UTF-8 (std::string)
+    template <typename Word>
+    void add(const Word &word, unsigned int value = 1)
     {
-        try
+        size_t before = _bloom ? _dict.size() : 0;
+        Key key = _key(word, true);
+        if constexpr (has_add<EDType>::value)
         {
-            _dict[key] += value;
+            _dict.add(key, value);
         }
-        catch (std::out_of_range &e)
+        else
+        {
+            try
+            {
+                _dict[key] += value;
+            }
+            catch (std::out_of_range &e)
+            {
+                _dict.insert(key, value);
+            }
+        }
+        // Só as palavras novas entram no filtro; passando da capacidade, ele é refeito com o dobro
+        if (_bloom && _dict.size() != before)
         {
-            _dict.insert(key, value);
+            if (_dict.size() > _bloom->capacity())
+                _rebuild_bloom(2 * _dict.size(), _bloom->target());
+            else
+                _bloom->add_hash(word_hash(word));
         }
     }
 
-    void remove(icu::UnicodeString key)
+    template <typename Word>
+    void remove(const Word &word)
     {
-        try
+        Key key = _key(word, false);
+        if constexpr (has_add<EDType>::value)
         {
-            _dict[key] -= 1;
-            if (_dict[key] <= 0)
+            // Estruturas com add próprio podem não expor referências aos valores (operator[])
+            if (missing_key(key) || !_dict.contains(key))
+            {
+                std::cerr << "Key not found" << std::endl;
+                return;
+            }
+            auto count = _dict.find(key);
+            if (count <= 1)
                 _dict.remove(key);
+            else
+                _dict.update(key, count - 1);
         }
-        catch (std::out_of_range &e)
+        else
         {
-            std::cerr << "Key not found" << std::endl;
+            try
+            {
+                if (missing_key(key))
+                    throw std::out_of_range("Key not found");
+                _dict[key] -= 1;
+                if (_dict[key] <= 0)
+                    _dict.remove(key);
+            }
+            catch (std::out_of_range &e)
+            {
+                std::cerr << "Key not found" << std::endl;
+            }
         }
     }
 
-    void update(icu::UnicodeString key, unsigned int value)
+    template <typename Word>
+    void update(const Word &word, unsigned int value)
+    {
+        Key key = _key(word, false);
+        if (!missing_key(key))
+            _dict.update(key, value);
+    }
+
+    template <typename Word>
+    int find(const Word &word)
     {
-        _dict.update(key, value);
+        if (_rejected(word))
+            return 0;
+        Key key = _key(word, false);
+        if (missing_key(key))
+            return 0;
+        try
+        {
+            return _dict.find(key);
+        }
+        catch (std::out_of_range &e)
+        {
+            return 0; // As tabelas de hash lançam exceção em vez de retornar o valor padrão
+        }
     }
 
-    int find(icu::UnicodeString key)
+    // Busca as frequências de n palavras (0 para as ausentes) e retorna quantas foram encontradas
+    // Nas estruturas com find_batch (as tabelas de hash) as chaves vão em lotes, para que as buscas
+    // sobreponham as faltas de cache; nas outras, são buscadas uma a uma
+    template <typename Word>
+    size_t find_batch(const Word *words, size_t n, int *out)
     {
-        return _dict.find(key);
+        size_t found = 0;
+        if constexpr (has_find_batch<EDType, Key>::value)
+        {
+            const size_t BATCH = 1024; // Palavras convertidas para chaves de cada vez
+            std::vector<Key> keys;
+            std::vector<size_t> positions;
+            std::vector<int> values(BATCH);
+            for (size_t start = 0; start < n; start += BATCH)
+            {
+                keys.clear();
+                positions.clear();
+                for (size_t i = start; i < n && i < start + BATCH; i++)
+                {
+                    out[i] = 0;
+                    if (_rejected(words[i]))
+                        continue;
+                    Key key = _key(words[i], false);
+                    if (missing_key(key))
+                        continue;
+                    keys.push_back(key);
+                    positions.push_back(i);
+                }
+                found += _dict.find_batch(keys.data(), keys.size(), values.data(), 0);
+                for (size_t j = 0; j < keys.size(); j++)
+                    out[positions[j]] = values[j];
+            }
+        }
+        else
+        {
+            for (size_t i = 0; i < n; i++)
+            {
+                out[i] = find(words[i]);
+                found += out[i] != 0;
+            }
+        }
+        return found;
     }
 
+    // Remove todas as palavras e recomeça com uma arena nova; a anterior é liberada quando o último
+    // snapshot que a usa for destruído
     void clear()
     {
         _dict.clear();
+        _arena = std::make_shared<KeyArena>();
+        if (_bloom)
+            _bloom->clear();
+    }
+
+    // Liga o filtro de Bloom na frente de find, contains e find_batch, com taxa de falso positivo fpr,
+    // dimensionado para expected palavras (no mínimo as atuais); as palavras atuais entram nele
+    // Com o filtro, as buscas de palavras ausentes costumam terminar em uma linha de cache, sem
+    // consultar a arena nem a estrutura. Não é seguro inserir de várias threads com o filtro ligado
+    void bloom(double fpr, size_t expected = 0)
+    {
+        _rebuild_bloom(std::max({expected, size(), size_t(1024)}), fpr);
+        _bloom_rejected = 0;
+    }
+
+    // Filtro de Bloom (nulo se desligado)
+    const BloomFilter *bloom_filter() const
+    {
+        return _bloom.get();
+    }
+
+    // Número de buscas respondidas pelo filtro sem consultar a estrutura
+    size_t bloom_rejections() const
+    {
+        return _bloom_rejected;
+    }
+
+    // Prepara a estrutura para n palavras distintas (só tem efeito nas estruturas com reserve)
+    void reserve(size_t n)
+    {
+        if constexpr (has_reserve<EDType>::value)
+            _dict.reserve(n);
     }
 
-    bool contains(icu::UnicodeString key)
+    template <typename Word>
+    bool contains(const Word &word)
     {
-        return _dict.contains(key);
+        if (_rejected(word))
+            return false;
+        Key key = _key(word, false);
+        return !missing_key(key) && _dict.contains(key);
     }
 
     size_t size()
@@ -70,10 +442,88 @@ public:
         return _dict.comparisons();
     }
 
+    // Estatísticas da estrutura (contadores das operações e forma atual)
+    EngineStats statistics() const
+    {
+        return _dict.statistics();
+    }
+
+    // Memória ocupada pelas palavras internadas (arena), em bytes
+    size_t key_bytes() const
+    {
+        return _arena->used();
+    }
+
+    // Memória ocupada pela estrutura; o texto das palavras (parte usada da arena) entra nas chaves
+    MemoryUsage memory() const
+    {
+        MemoryUsage m = _dict.memory();
+        m.keys += _arena->used();
+        if (_bloom)
+            m.structure += _bloom->bytes();
+        return m;
+    }
+
     void print()
     {
         _dict.print();
     }
+
+    void print(OutputBuffer &out)
+    {
+        _dict.print(out);
+    }
+
+    // Retorna as k palavras mais frequentes, da mais frequente para a menos frequente
+    auto top_k(size_t k)
+    {
+        return _dict.top_k(k);
+    }
+
+    // Versão imutável da estrutura (só nas que têm snapshot, como a PersistentAVLTree)
+    // Pode ser lida por outras threads enquanto a inserção continua; guarda a arena das chaves com ela
+    template <typename E = EDType, typename = std::enable_if_t<has_snapshot<E>::value>>
+    DictSnapshot<decltype(std::declval<const E &>().snapshot())> snapshot() const
+    {
+        return DictSnapshot<decltype(std::declval<const E &>().snapshot())>(_dict.snapshot(), _arena);
+    }
+
+    // Palavras e frequências na ordem da lista (percorre a estrutura com for_each)
+    std::vector<std::pair<std::string, uint32_t>> entries() const
+    {
+        std::vector<std::pair<std::string, uint32_t>> result;
+        result.reserve(_dict.size());
+        _dict.for_each([&result](const Key &key, const auto &value)
+                       { result.emplace_back(key_text(key), static_cast<uint32_t>(value)); });
+        return result;
+    }
+
+    // Grava as palavras e frequências em um snapshot binário (veja Snapshot.h), na ordem da lista
+    bool save(const std::string &path, bool table = true)
+    {
+        return Snapshot::save(path, entries(), table);
+    }
+
+    // Cria a versão imutável do dicionário, otimizada para consultas (veja FrozenDict.h)
+    // O dicionário continua válido e independente da versão criada
+    FrozenDict<typename comparator_of<EDType>::type> freeze()
+    {
+        return FrozenDict<typename comparator_of<EDType>::type>(Snapshot::build(entries(), false, true));
+    }
+
+    // Insere as palavras de um snapshot com as suas frequências (sem reler nem tokenizar o texto)
+    void load(const Snapshot &snapshot)
+    {
+        reserve(size() + snapshot.size());
+        for (size_t i = 0; i < snapshot.size(); i++)
+            add(snapshot.word(i), snapshot.count(i));
+    }
+
+    void load(const std::string &path)
+    {
+        Snapshot snapshot(path);
+        load(snapshot);
+    }
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,399 @@
+#ifndef ENGINESTATS_H
+#define ENGINESTATS_H
+
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "OutputBuffer.h"
+
+// Histograma de comprimentos (de buscas ou de listas de colisão)
+// Os comprimentos de 0 a 15 têm uma posição cada; os maiores são agrupados em potências de 2
+// (16-31, 32-63, ...), então caudas longas (colisões, árvores degeneradas) continuam visíveis
+class LengthHistogram
+{
+public:
+    static const size_t LINEAR = 16; // Comprimentos com uma posição própria
+    static const size_t BUCKETS = 40; // Número de posições
+
+private:
+    uint64_t m_counts[BUCKETS] = {};
+    uint64_t m_total = 0; // Número de amostras
+    uint64_t m_sum = 0;   // Soma dos comprimentos
+    uint64_t m_max = 0;   // Maior comprimento
+
+public:
+    // Posição do histograma de um comprimento
+    static size_t bucket(uint64_t length)
+    {
+        if (length < LINEAR)
+            return static_cast<size_t>(length);
+        size_t b = LINEAR + (63 - __builtin_clzll(length)) - 4;
+        return b < BUCKETS ? b : BUCKETS - 1;
+    }
+
+    // Menor comprimento da posição b
+    static uint64_t lower(size_t b)
+    {
+        return b < LINEAR ? b : uint64_t(1) << (b - LINEAR + 4);
+    }
+
+    void record(uint64_t length)
+    {
+        m_counts[bucket(length)]++;
+        m_total++;
+        m_sum += length;
+        if (length > m_max)
+            m_max = length;
+    }
+
+    uint64_t operator[](size_t b) const
+    {
+        return m_counts[b];
+    }
+
+    uint64_t total() const { return m_total; }
+    uint64_t max() const { return m_max; }
+
+    double mean() const
+    {
+        return m_total == 0 ? 0.0 : static_cast<double>(m_sum) / m_total;
+    }
+
+    void clear()
+    {
+        *this = LengthHistogram();
+    }
+
+    // Imprime as posições não vazias ("comprimento: quantidade")
+    void print(OutputBuffer &out) const
+    {
+        for (size_t b = 0; b < BUCKETS; b++)
+        {
+            if (m_counts[b] == 0)
+                continue;
+            out << "    " << lower(b);
+            if (b >= LINEAR)
+                out << '-' << (lower(b + 1) - 1);
+            out << ": " << m_counts[b] << '\n';
+        }
+    }
+
+    // Grava em JSON ({"mean": x, "max": n, "buckets": {"comprimento": quantidade, ...}})
+    void write_json(std::ostream &os) const
+    {
+        os << "{\"samples\": " << m_total << ", \"mean\": " << mean() << ", \"max\": " << m_max << ", \"buckets\": {";
+        bool first = true;
+        for (size_t b = 0; b < BUCKETS; b++)
+        {
+            if (m_counts[b] == 0)
+                continue;
+            os << (first ? "" : ", ") << '"' << lower(b);
+            if (b >= LINEAR)
+                os << '-' << (lower(b + 1) - 1);
+            os << "\": " << m_counts[b];
+            first = false;
+        }
+        os << "}}";
+    }
+};
+
+// Organização da estrutura (define quais estatísticas estruturais fazem sentido)
+enum class EngineLayout
+{
+    Tree,           // Árvore de busca (altura, rotações)
+    SkipList,       // Skip list (altura = número de níveis em uso)
+    Chaining,       // Tabela de hash com listas de colisão
+    OpenAddressing  // Tabela de hash com sondagem linear (posições removidas)
+};
+
+// Estatísticas de uma estrutura: contadores das operações (64 bits) e o retrato da sua forma
+struct EngineStats
+{
+    EngineLayout layout = EngineLayout::Tree;
+    bool counted = true; // false quando a estrutura foi compilada sem contadores (NoStats)
+
+    // Operações (e rotações/rehash): só com counted
+    uint64_t lookups = 0;          // Buscas (find, contains, operator[])
+    uint64_t inserts = 0;          // Chaves inseridas
+    uint64_t removes = 0;          // Chaves removidas
+    uint64_t updates = 0;          // Valores substituídos por update
+    uint64_t comparisons = 0;      // Comparações entre chaves (cada chamada ao comparador ou a ==)
+    LengthHistogram probe_lengths; // Nós ou posições visitados em cada busca (de todas as operações)
+
+    // Árvores
+    uint64_t single_rotations = 0; // Rotações simples
+    uint64_t double_rotations = 0; // Rotações duplas
+    size_t height = 0;             // Altura (número de níveis, 0 se vazia)
+
+    // Tabelas de hash
+    uint64_t rehashes = 0;         // Número de reconstruções da tabela
+    uint64_t rehash_ns = 0;        // Tempo total das reconstruções, em nanossegundos
+    size_t buckets = 0;            // Número de posições
+    double load_factor = 0;        // Elementos / posições
+    size_t tombstones = 0;         // Posições removidas (sondagem linear)
+    double tombstone_ratio = 0;    // Posições removidas / posições
+    LengthHistogram chain_lengths; // Comprimento de cada lista de colisão (encadeamento)
+
+    size_t size = 0; // Número de elementos
+
+    bool tree() const
+    {
+        return layout == EngineLayout::Tree || layout == EngineLayout::SkipList;
+    }
+
+    // Imprime as estatísticas no cabeçalho da saída
+    void print(OutputBuffer &out) const
+    {
+        out << "Estatísticas da estrutura: " << '\n';
+        if (counted)
+        {
+            out << "  Buscas: " << lookups << '\n';
+            out << "  Inserções: " << inserts << '\n';
+            out << "  Remoções: " << removes << '\n';
+            out << "  Atualizações: " << updates << '\n';
+            out << "  Comparações: " << comparisons << '\n';
+        }
+        if (tree())
+        {
+            out << "  Altura: " << height << '\n';
+            if (layout == EngineLayout::Tree && counted)
+                out << "  Rotações simples: " << single_rotations << '\n'
+                    << "  Rotações duplas: " << double_rotations << '\n';
+        }
+        else
+        {
+            out << "  Posições: " << buckets << '\n';
+            out << "  Fator de carga: " << load_factor << '\n';
+            if (counted)
+                out << "  Rehash: " << rehashes << " (" << rehash_ns << " ns)" << '\n';
+            if (layout == EngineLayout::OpenAddressing)
+                out << "  Posições removidas: " << tombstones << " (" << tombstone_ratio << " das posições)" << '\n';
+        }
+        if (probe_lengths.total() > 0)
+        {
+            out << "  Comprimento das buscas (média " << probe_lengths.mean() << ", máximo " << probe_lengths.max() << "): " << '\n';
+            probe_lengths.print(out);
+        }
+        if (layout == EngineLayout::Chaining)
+        {
+            out << "  Comprimento das listas (média " << chain_lengths.mean() << ", máximo " << chain_lengths.max() << "): " << '\n';
+            chain_lengths.print(out);
+        }
+    }
+
+    // Grava as estatísticas em JSON
+    void write_json(std::ostream &os) const
+    {
+        static const char *layouts[] = {"tree", "skiplist", "chaining", "open_addressing"};
+        os << "{\n  \"layout\": \"" << layouts[static_cast<int>(layout)] << "\",\n  \"size\": " << size
+           << ",\n  \"counted\": " << (counted ? "true" : "false");
+        if (counted)
+            os << ",\n  \"lookups\": " << lookups << ",\n  \"inserts\": " << inserts << ",\n  \"removes\": " << removes
+               << ",\n  \"updates\": " << updates << ",\n  \"comparisons\": " << comparisons;
+        if (tree())
+        {
+            os << ",\n  \"height\": " << height;
+            if (counted)
+                os << ",\n  \"single_rotations\": " << single_rotations << ",\n  \"double_rotations\": " << double_rotations;
+        }
+        else
+        {
+            os << ",\n  \"buckets\": " << buckets << ",\n  \"load_factor\": " << load_factor << ",\n  \"tombstones\": " << tombstones
+               << ",\n  \"tombstone_ratio\": " << tombstone_ratio;
+            if (counted)
+                os << ",\n  \"rehashes\": " << rehashes << ",\n  \"rehash_ns\": " << rehash_ns;
+        }
+        if (counted)
+        {
+            os << ",\n  \"probe_lengths\": ";
+            probe_lengths.write_json(os);
+        }
+        if (layout == EngineLayout::Chaining)
+        {
+            os << ",\n  \"chain_lengths\": ";
+            chain_lengths.write_json(os);
+        }
+        os << "\n}\n";
+    }
+};
+
+// Altura de uma árvore binária com ponteiros left e right (iterativa, nível por nível)
+template <typename NodeT>
+size_t tree_height(const NodeT *root)
+{
+    size_t h = 0;
+    std::vector<const NodeT *> level;
+    if (root != nullptr)
+        level.push_back(root);
+    while (!level.empty())
+    {
+        std::vector<const NodeT *> next;
+        for (const NodeT *node : level)
+        {
+            if (node->left != nullptr)
+                next.push_back(node->left);
+            if (node->right != nullptr)
+                next.push_back(node->right);
+        }
+        level.swap(next);
+        h++;
+    }
+    return h;
+}
+
+// Políticas de instrumentação (parâmetro Stats das estruturas)
+// CountingStats mantém os contadores; NoStats tem a mesma interface com funções vazias, então
+// toda a contagem some na compilação (nenhuma escrita extra nos laços de busca e de sondagem)
+
+// Contadores mantidos por uma estrutura durante as operações
+// As estruturas chamam visit() para cada nó ou posição visitado e end_search() no fim de cada
+// busca (o comprimento vai para o histograma); statistics() da estrutura completa o retrato com a forma atual
+class CountingStats
+{
+private:
+    EngineStats m_stats;
+    uint64_t m_path = 0; // Nós ou posições visitados na busca atual
+
+public:
+    typedef std::chrono::steady_clock::time_point Clock;
+    static const bool enabled = true;
+
+    void compare(uint64_t n = 1) { m_stats.comparisons += n; }
+    void visit() { m_path++; }
+
+    void end_search()
+    {
+        m_stats.probe_lengths.record(m_path);
+        m_path = 0;
+    }
+
+    void lookup() { m_stats.lookups++; }
+    void insert() { m_stats.inserts++; }
+    void remove() { m_stats.removes++; }
+    void update() { m_stats.updates++; }
+
+    void rotation(bool double_rotation)
+    {
+        if (double_rotation)
+            m_stats.double_rotations++;
+        else
+            m_stats.single_rotations++;
+    }
+
+    // Início e fim de um rehash (conta e soma o tempo)
+    Clock rehash_begin() const
+    {
+        return std::chrono::steady_clock::now();
+    }
+
+    void rehash_end(Clock start)
+    {
+        m_stats.rehashes++;
+        m_stats.rehash_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    uint64_t comparisons() const
+    {
+        return m_stats.comparisons;
+    }
+
+    // Contadores acumulados (as estatísticas estruturais ficam a cargo da estrutura)
+    const EngineStats &counters() const
+    {
+        return m_stats;
+    }
+
+    void clear()
+    {
+        m_stats = EngineStats();
+        m_path = 0;
+    }
+};
+
+// Política sem contagem: as estatísticas ficam só com a forma da estrutura (contadores zerados)
+class NoStats
+{
+public:
+    typedef std::chrono::steady_clock::time_point Clock;
+    static const bool enabled = false;
+
+    void compare(uint64_t = 1) {}
+    void visit() {}
+    void end_search() {}
+    void lookup() {}
+    void insert() {}
+    void remove() {}
+    void update() {}
+    void rotation(bool) {}
+
+    // O relógio não é lido
+    Clock rehash_begin() const
+    {
+        return Clock();
+    }
+
+    void rehash_end(Clock) {}
+
+    uint64_t comparisons() const
+    {
+        return 0;
+    }
+
+    EngineStats counters() const
+    {
+        EngineStats s;
+        s.counted = false;
+        return s;
+    }
+
+    void clear() {}
+};
+
+// Contadores de uma estrutura concorrente (várias threads inserindo ao mesmo tempo)
+// Com CountingStats são atômicos e sem histograma das buscas (que não seria seguro entre threads);
+// com NoStats não há nada para contar
+template <typename Stats>
+class SharedStats : public NoStats
+{
+};
+
+template <>
+class SharedStats<CountingStats>
+{
+private:
+    std::atomic<uint64_t> m_comparisons{0};
+    std::atomic<uint64_t> m_lookups{0};
+    std::atomic<uint64_t> m_inserts{0};
+    std::atomic<uint64_t> m_removes{0};
+    std::atomic<uint64_t> m_updates{0};
+
+public:
+    static const bool enabled = true;
+
+    void compare(uint64_t n = 1) { m_comparisons.fetch_add(n, std::memory_order_relaxed); }
+    void lookup() { m_lookups.fetch_add(1, std::memory_order_relaxed); }
+    void insert() { m_inserts.fetch_add(1, std::memory_order_relaxed); }
+    void remove() { m_removes.fetch_add(1, std::memory_order_relaxed); }
+    void update() { m_updates.fetch_add(1, std::memory_order_relaxed); }
+
+    uint64_t comparisons() const
+    {
+        return m_comparisons.load(std::memory_order_relaxed);
+    }
+
+    EngineStats counters() const
+    {
+        EngineStats s;
+        s.lookups = m_lookups.load(std::memory_order_relaxed);
+        s.inserts = m_inserts.load(std::memory_order_relaxed);
+        s.removes = m_removes.load(std::memory_order_relaxed);
+        s.updates = m_updates.load(std::memory_order_relaxed);
+        s.comparisons = comparisons();
+        return s;
+    }
+};
+
+#endif
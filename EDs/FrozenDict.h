@@ -0,0 +1,186 @@
+#ifndef FROZENDICT_H
+#define FROZENDICT_H
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "Snapshot.h"
+#include "TrackingAllocator.h"
+
+// Dicionário imutável otimizado para consultas, criado por Dict::freeze() depois da inserção
+// Guarda as palavras em um único blob contíguo, na ordem da lista (ordem do comparador), com:
+//   - uma árvore de Eytzinger (árvore binária de busca implícita em um vetor, em largura: os filhos
+//     da posição k estão em 2k e 2k + 1), para buscas ordenadas (lower_bound/upper_bound) sem
+//     desvios dependentes do resultado da comparação e com o próximo nível sempre por perto na cache;
+//   - um hash perfeito mínimo (hash and displace), para consultas de uma palavra com uma posição lida
+//     e uma comparação de bytes, sem colisões e sem posições vazias.
+// A memória é a mesma imagem de um snapshot FROZEN (veja Snapshot.h): save grava a imagem como está e
+// o construtor com caminho mapeia o arquivo, sem reconstruir nada
+// O comparador precisa aceitar std::string_view (como u_comparator)
+template <typename COMPARATOR>
+class FrozenDict
+{
+private:
+    std::unique_ptr<Snapshot> m_snapshot;
+    COMPARATOR compare;
+    mutable size_t comps = 0; // Comparações das buscas ordenadas
+
+    // Verifica se a palavra de índice i vem antes de w (conta a comparação)
+    bool less(size_t i, std::string_view w) const
+    {
+        comps++;
+        return compare(m_snapshot->word(i), w);
+    }
+
+    bool greater(size_t i, std::string_view w) const
+    {
+        comps++;
+        return compare(w, m_snapshot->word(i));
+    }
+
+    // Desce a árvore de Eytzinger indo para a direita enquanto go_right(índice) e retorna o índice
+    // (na ordem da lista) do último nó de onde desceu para a esquerda, ou size() se não houver
+    // O passo k = 2k + go_right não tem desvio dependente da comparação; no fim, os bits 1 do final
+    // de k são as descidas para a direita depois da última descida para a esquerda, e são descartados
+    template <typename GoRight>
+    size_t descend(GoRight go_right) const
+    {
+        const uint32_t *tree = m_snapshot->eytzinger();
+        size_t n = size();
+        size_t k = 1;
+        while (k <= n)
+        {
+            __builtin_prefetch(tree + 16 * k); // Descendentes 4 níveis abaixo (16 índices contíguos)
+            k = 2 * k + static_cast<size_t>(go_right(tree[k]));
+        }
+        k >>= __builtin_ffsll(static_cast<long long>(~k));
+        return k == 0 ? n : tree[k];
+    }
+
+public:
+    // Cria a partir da imagem de um snapshot FROZEN montada em memória (Snapshot::build)
+    explicit FrozenDict(std::vector<char> image, COMPARATOR comp = COMPARATOR())
+        : m_snapshot(new Snapshot(std::move(image))), compare(comp)
+    {
+        if (!m_snapshot->frozen())
+            throw std::runtime_error("Invalid frozen dictionary: image is not frozen");
+    }
+
+    // Abre um snapshot FROZEN gravado por save (mapeado com mmap, sem reconstrução)
+    // Lança std::runtime_error se o arquivo não for um snapshot FROZEN válido
+    explicit FrozenDict(const std::string &path, COMPARATOR comp = COMPARATOR())
+        : m_snapshot(new Snapshot(path)), compare(comp)
+    {
+        if (!m_snapshot->frozen())
+            throw std::runtime_error("Invalid frozen dictionary " + path + ": snapshot is not frozen");
+    }
+
+    // Número de palavras
+    size_t size() const
+    {
+        return m_snapshot->size();
+    }
+
+    // Palavra de índice i (na ordem da lista)
+    std::string_view word(size_t i) const
+    {
+        return m_snapshot->word(i);
+    }
+
+    // Frequência da palavra de índice i
+    uint32_t count(size_t i) const
+    {
+        return m_snapshot->count(i);
+    }
+
+    // Frequência de uma palavra (0 se ela não estiver no dicionário), pelo hash perfeito
+    uint32_t find(std::string_view w) const
+    {
+        return m_snapshot->find(w);
+    }
+
+    bool contains(std::string_view w) const
+    {
+        return m_snapshot->contains(w);
+    }
+
+    // Índice da primeira palavra que não vem antes de w (size() se todas vêm antes)
+    size_t lower_bound(std::string_view w) const
+    {
+        return descend([this, w](uint32_t i)
+                       { return less(i, w); });
+    }
+
+    // Índice da primeira palavra que vem depois de w (size() se nenhuma vem depois)
+    size_t upper_bound(std::string_view w) const
+    {
+        return descend([this, w](uint32_t i)
+                       { return !greater(i, w); });
+    }
+
+    // Retorna as palavras de from (inclusive) até to (exclusive), na ordem, com as frequências
+    std::vector<std::pair<std::string_view, uint32_t>> range(std::string_view from, std::string_view to) const
+    {
+        std::vector<std::pair<std::string_view, uint32_t>> result;
+        for (size_t i = lower_bound(from), end = lower_bound(to); i < end; i++)
+            result.emplace_back(word(i), count(i));
+        return result;
+    }
+
+    // Retorna as palavras que começam com os bytes de p, na ordem (no máximo limit, 0 = todas)
+    // Na ordem alfabética as palavras com o prefixo não são necessariamente contíguas (acentos só pesam
+    // depois das letras: "abc" < "ábd" < "abe"), mas todas ficam entre p e p seguido de U+FFFF (o maior
+    // peso do ICU); o intervalo é percorrido filtrando os bytes
+    std::vector<std::pair<std::string_view, uint32_t>> prefix(std::string_view p, size_t limit = 0) const
+    {
+        std::vector<std::pair<std::string_view, uint32_t>> result;
+        std::string last(p);
+        last += "\xEF\xBF\xBF"; // U+FFFF em UTF-8
+        for (size_t i = lower_bound(p), end = lower_bound(last); i < end && (limit == 0 || result.size() < limit); i++)
+        {
+            if (word(i).substr(0, p.size()) == p)
+                result.emplace_back(word(i), count(i));
+        }
+        return result;
+    }
+
+    // Retorna o número de comparações das buscas ordenadas
+    size_t comparisons() const
+    {
+        return comps;
+    }
+
+    // Memória da imagem: chaves (blob e offsets), valores (frequências) e estrutura (árvore e hash perfeito)
+    MemoryUsage memory() const
+    {
+        MemoryUsage m;
+        m.keys = m_snapshot->blob_bytes() + (size() + 1) * sizeof(uint32_t);
+        m.values = size() * sizeof(uint32_t);
+        m.structure = m_snapshot->bytes() - m.keys - m.values;
+        m.allocations = 1;
+        m.peak = m_snapshot->bytes();
+        return m;
+    }
+
+    // Grava o dicionário como snapshot FROZEN (pode ser aberto de novo por FrozenDict ou por Dict::load)
+    bool save(const std::string &path) const
+    {
+        return m_snapshot->save(path);
+    }
+
+    void print(OutputBuffer &out) const
+    {
+        m_snapshot->print(out);
+    }
+
+    // Retorna as k palavras mais frequentes, da mais frequente para a menos frequente
+    std::vector<std::pair<std::string_view, uint32_t>> top_k(size_t k) const
+    {
+        return m_snapshot->top_k(k);
+    }
+};
+
+#endif
@@ -14,20 +14,32 @@
 #include <unicode/ucnv.h>
 #include <unicode/coll.h>
 #include "extras.h"
+#include "OutputBuffer.h"
+#include "TopK.h"
+#include "CollationSort.h"
+#include "EngineStats.h"
+#include "TrackingAllocator.h"
 
 // Template de classe HashTable com parâmetros genéricos para a chave (Key), valor (Value),
 // comparador (COMPARATOR) e função de hash (Hash)
-template <typename Key, typename Value = int, typename COMPARATOR = comparator<Key>, typename Hash = std::hash<Key>>
+template <typename Key, typename Value = int, typename COMPARATOR = comparator<Key>, typename Hash = std::hash<Key>, typename Stats = CountingStats>
 class HashTable
 {
 private:
+    // Listas de colisão e vetor de buckets com alocação contada em mem
+    typedef std::list<std::pair<Key, Value>, TrackingAllocator<std::pair<Key, Value>>> Bucket;
+    typedef std::vector<Bucket, TrackingAllocator<Bucket>> Table;
+
+    static constexpr size_t FIND_BATCH = 16; // Chaves buscadas juntas por find_batch
+
     size_t m_number_of_elements;                            // Número de elementos inseridos na tabela
     size_t m_table_size;                                    // Tamanho da tabela de hash (número de buckets)
-    std::vector<std::list<std::pair<Key, Value>>> *m_table; // Ponteiro para o vetor de listas que representa a tabela de hash
+    Table *m_table;                                         // Ponteiro para o vetor de listas que representa a tabela de hash
     float m_load_factor;                                    // Fator de carga atual da tabela (número de elementos / tamanho da tabela)
     float m_max_load_factor;                                // Fator de carga máximo permitido antes de rehashing
     Hash m_hashing;                                         // Função de hash
-    unsigned int comps = 0;                                 // Contador de comparações realizadas
+    Stats stats;                                            // Contadores de operações e comparações
+    MemoryCounter mem;                                      // Memória alocada pelo vetor de buckets e pelos nós das listas
     COMPARATOR compare;                                     // Comparador para ordenar os elementos
 
     // Função privada que retorna o próximo número primo maior ou igual a x
@@ -53,6 +65,12 @@ private:
         return x - 2;
     }
 
+    // Função privada que cria um vetor de n buckets vazios (contado em mem)
+    Table *new_table(size_t n)
+    {
+        return tracked_new<Table>(mem, n, Bucket(TrackingAllocator<std::pair<Key, Value>>(&mem)), TrackingAllocator<Bucket>(&mem));
+    }
+
     // Função privada que calcula o código de hash para uma chave e mapeia para o índice da tabela
     size_t hash_code(const Key &k) const
     {
@@ -60,61 +78,27 @@ private:
     }
 
     // Função privada que imprime a tabela de hash de forma não ordenada (bucket por bucket)
-    void unordered_print()
+    void unordered_print(OutputBuffer &out)
     {
-        std::cout << "HashTable" << std::endl;
+        out << "HashTable" << '\n';
         for (size_t i = 0; i < m_table_size; i++)
         {
-            std::cout << i << ": ";
+            out << i << ": ";
             for (auto &p : (*m_table)[i])
             {
-                // Se a chave for do tipo icu::UnicodeString, converte para UTF-8 antes de imprimir
-                if constexpr (std::is_same<Key, icu::UnicodeString>::value)
-                {
-                    std::string skey;
-                    p.first.toUTF8String(skey);
-                    std::cout << skey << " ";
-                }
-                else
-                    std::cout << p.first << " ";
+                out << p.first << ' ';
             }
-            std::cout << std::endl;
+            out << '\n';
         }
-        std::cout << std::endl;
+        out << '\n';
     }
 
     // Função privada que imprime os elementos da tabela de hash de forma ordenada
-    void ordered_print()
+    void ordered_print(OutputBuffer &out)
     {
-        std::vector<std::pair<Key, Value>> elements;
-        elements.reserve(m_number_of_elements); // Reserva espaço para todos os elementos
-
-        // Coleta todos os elementos da tabela de hash
-        for (size_t i = 0; i < m_table_size; ++i)
-        {
-            for (const auto &p : (*m_table)[i])
-            {
-                elements.push_back(p);
-            }
-        }
-
-        // Ordena os elementos usando o comparador fornecido
-        std::sort(elements.begin(), elements.end(), [this](const std::pair<Key, Value> &a, const std::pair<Key, Value> &b)
-                  { return compare(a.first, b.first); });
-
-        // Imprime os elementos ordenados
-        for (const auto &p : elements)
-        {
-            if constexpr (std::is_same<Key, icu::UnicodeString>::value)
-            {
-                std::string skey;
-                p.first.toUTF8String(skey);
-                std::cout << skey << ": " << p.second << std::endl;
-            }
-            else
-                std::cout << p.first << ": " << p.second << std::endl;
-        }
-        std::cout << std::endl;
+        for_each([&out](const Key &key, const Value &value)
+                 { out.entry(key, value); });
+        out << '\n';
     }
 
 public:
@@ -128,7 +112,7 @@ public:
         compare = comp;
         m_number_of_elements = 0;
         m_table_size = tableSize;
-        m_table = new std::vector<std::list<std::pair<Key, Value>>>(m_table_size);
+        m_table = new_table(m_table_size);
         m_load_factor = 0.75;
         m_max_load_factor = 1;
         m_hashing = hf;
@@ -190,79 +174,137 @@ public:
     ~HashTable()
     {
         clear();
-        delete m_table;
+        tracked_delete(mem, m_table);
     }
 
     // Insere uma chave e um valor na tabela de hash, realiza rehash se necessário
     bool insert(const Key &k, const Value &v)
     {
         // Verifica se o fator de carga ultrapassou o limite e realiza rehash se necessário
-        if (m_number_of_elements / m_table_size > m_load_factor)
+        if (static_cast<float>(m_number_of_elements) / m_table_size > m_load_factor)
         {
             rehash(2 * m_table_size);
         }
         size_t i = hash_code(k);
         for (auto &p : (*m_table)[i])
         {
-            comps++;
+            stats.visit();
+            stats.compare();
             if (p.first == k)
             {
+                stats.end_search();
                 return false;
             }
         }
+        stats.end_search();
         (*m_table)[i].push_back(std::make_pair(k, v)); // Insere nova chave-valor
         m_number_of_elements++;
+        stats.insert();
         return true;
     }
 
     // Verifica se uma chave está presente na tabela
     bool contains(const Key &k)
     {
+        stats.lookup();
         size_t i = hash_code(k);
         for (auto &p : (*m_table)[i])
         {
-            comps++;
+            stats.visit();
+            stats.compare();
             if (p.first == k)
             {
+                stats.end_search();
                 return true;
             }
         }
+        stats.end_search();
         return false;
     }
 
     // Busca o valor associado a uma chave na tabela
     Value &find(const Key &k)
     {
+        stats.lookup();
         size_t i = hash_code(k);
         for (auto &p : (*m_table)[i])
         {
-            comps++;
+            stats.visit();
+            stats.compare();
             if (p.first == k)
             {
+                stats.end_search();
                 return p.second;
             }
         }
+        stats.end_search();
         throw std::out_of_range("Key not found"); // Lança exceção se a chave não for encontrada
     }
 
+    // Busca n chaves de uma vez: grava em out o valor de cada uma (missing se ausente) e retorna quantas foram encontradas
+    // As chaves são tratadas em grupos de FIND_BATCH, em três passadas: calcula o bucket de todas e pede
+    // o cabeçalho de cada lista à cache (__builtin_prefetch), pede o primeiro nó de cada lista (o
+    // cabeçalho já chegou) e só então percorre as listas; assim as faltas de cache do grupo acontecem
+    // ao mesmo tempo, em vez de duas por chave, uma depois da outra
+    size_t find_batch(const Key *keys, size_t n, Value *out, const Value &missing = Value())
+    {
+        size_t found = 0;
+        size_t buckets[FIND_BATCH];
+        for (size_t start = 0; start < n; start += FIND_BATCH)
+        {
+            size_t count = std::min(FIND_BATCH, n - start);
+            for (size_t j = 0; j < count; j++)
+            {
+                buckets[j] = hash_code(keys[start + j]);
+                __builtin_prefetch(&(*m_table)[buckets[j]]);
+            }
+            for (size_t j = 0; j < count; j++)
+            {
+                const Bucket &bucket = (*m_table)[buckets[j]];
+                if (!bucket.empty())
+                    __builtin_prefetch(&bucket.front());
+            }
+            for (size_t j = 0; j < count; j++)
+            {
+                stats.lookup();
+                out[start + j] = missing;
+                for (auto &p : (*m_table)[buckets[j]])
+                {
+                    stats.visit();
+                    stats.compare();
+                    if (p.first == keys[start + j])
+                    {
+                        out[start + j] = p.second;
+                        found++;
+                        break;
+                    }
+                }
+                stats.end_search();
+            }
+        }
+        return found;
+    }
+
     // Reorganiza a tabela de hash com um novo tamanho
     void rehash(size_t m)
     {
         if (m <= m_table_size)
             return;
+        typename Stats::Clock start = stats.rehash_begin();
         size_t new_size = get_next_prime(m); // Obtém o próximo primo para o novo tamanho
-        std::vector<std::list<std::pair<Key, Value>>> *new_table = new std::vector<std::list<std::pair<Key, Value>>>(new_size);
+        Table *table = new_table(new_size);
         for (size_t i = 0; i < m_table_size; i++)
         {
             for (auto &p : (*m_table)[i])
             {
                 size_t j = m_hashing(p.first) % new_size; // Recalcula o índice para a nova tabela
-                (*new_table)[j].push_back(p);
+                (*table)[j].push_back(p);
             }
         }
-        delete m_table; // Libera a memória da tabela antiga
-        m_table = new_table;
+        tracked_delete(mem, m_table); // Libera a memória da tabela antiga
+        m_table = table;
         m_table_size = new_size;
+        stats.rehash_end(start);
     }
 
     // Remove um elemento da tabela com base na chave
@@ -271,13 +313,18 @@ public:
         size_t i = hash_code(k);
         for (auto it = (*m_table)[i].begin(); it != (*m_table)[i].end(); ++it)
         {
+            stats.visit();
+            stats.compare();
             if (it->first == k)
             {
+                stats.end_search();
                 (*m_table)[i].erase(it); // Remove o par chave-valor do bucket
                 m_number_of_elements--;
+                stats.remove();
                 return true;
             }
         }
+        stats.end_search();
         return false;
     }
 
@@ -287,35 +334,109 @@ public:
         size_t i = hash_code(k);
         for (auto it = (*m_table)[i].begin(); it != (*m_table)[i].end(); ++it)
         {
-            comps++;
+            stats.visit();
+            stats.compare();
             if (it->first == k)
             {
+                stats.end_search();
                 it->second = v; // Atualiza o valor da chave
+                stats.update();
                 return true;
             }
         }
+        stats.end_search();
         return false;
     }
 
     // Imprime a tabela (por padrão, imprime de forma ordenada)
     void print()
     {
-        // unordered_print();
-        ordered_print();
+        OutputBuffer out;
+        print(out);
+    }
+
+    // Imprime a tabela em um buffer de saída
+    void print(OutputBuffer &out)
+    {
+        // unordered_print(out);
+        ordered_print(out);
+    }
+
+    // Chama fn(chave, valor) para cada elemento, na ordem da lista impressa
+    // Ordena apenas ponteiros para os elementos (sem copiar as chaves), pela ordem de collation_order
+    template <typename F>
+    void for_each(F fn) const
+    {
+        std::vector<const std::pair<Key, Value> *> elements;
+        elements.reserve(m_number_of_elements); // Reserva espaço para todos os elementos
+
+        // Coleta todos os elementos da tabela de hash
+        for (size_t i = 0; i < m_table_size; ++i)
+        {
+            for (const auto &p : (*m_table)[i])
+            {
+                elements.push_back(&p);
+            }
+        }
+
+        // Ordena os elementos usando o comparador fornecido
+        std::vector<uint32_t> order = collation_order(elements.size(), [&elements](size_t i) -> const Key &
+                                                      { return elements[i]->first; }, compare);
+
+        for (uint32_t i : order)
+        {
+            fn(elements[i]->first, elements[i]->second);
+        }
+    }
+
+    // Retorna as k chaves de maior valor, da maior para a menor (sem ordenar a tabela inteira)
+    std::vector<std::pair<Key, Value>> top_k(size_t k) const
+    {
+        TopK<Key, Value, COMPARATOR> top(k, compare);
+        for (size_t i = 0; i < m_table_size; ++i)
+        {
+            for (const auto &p : (*m_table)[i])
+            {
+                top.offer(p.first, p.second);
+            }
+        }
+        return top.result();
     }
 
     // Retorna o número de comparações realizadas
     size_t comparisons()
     {
-        return comps;
+        return stats.comparisons();
+    }
+
+    // Retorna as estatísticas da tabela (contadores e comprimento de cada lista de colisão)
+    EngineStats statistics() const
+    {
+        EngineStats s = stats.counters();
+        s.layout = EngineLayout::Chaining;
+        s.buckets = m_table_size;
+        s.load_factor = static_cast<double>(m_number_of_elements) / m_table_size;
+        for (size_t i = 0; i < m_table_size; ++i)
+        {
+            s.chain_lengths.record((*m_table)[i].size());
+        }
+        s.size = m_number_of_elements;
+        return s;
+    }
+
+    // Retorna a memória ocupada pela tabela (buckets, nós das listas, chaves e valores)
+    MemoryUsage memory() const
+    {
+        return mem.usage(m_number_of_elements, sizeof(Key), sizeof(Value));
     }
 
     // Garante que a tabela tenha espaço suficiente para um certo número de elementos
+    // (sem ultrapassar o fator de carga, então as n inserções não causam nenhum rehash)
     void reserve(size_t n)
     {
         if (n > m_table_size * m_load_factor)
         {
-            rehash(n);
+            rehash(static_cast<size_t>(std::ceil(n / m_load_factor)) + 1);
         }
     }
 
@@ -350,15 +471,19 @@ public:
     // Operador de índice const para acessar elementos na tabela
     Value &operator[](const Key &k)
     {
+        stats.lookup();
         size_t i = hash_code(k);
         for (auto &p : (*m_table)[i])
         {
-            comps++;
+            stats.visit();
+            stats.compare();
             if (p.first == k)
             {
+                stats.end_search();
                 return p.second;
             }
         }
+        stats.end_search();
         throw std::out_of_range("Key not found"); // Lança exceção se a chave não for encontrada
     }
 };
@@ -2,6 +2,7 @@
 #define HASHTABLE2_H
 
 #include <iostream>
+#include <algorithm>
 #include <cmath>
 #include <string>
 #include <vector>
@@ -11,10 +12,15 @@
 #include <unicode/ucnv.h>
 #include <unicode/coll.h>
 #include "extras.h"
+#include "OutputBuffer.h"
+#include "TopK.h"
+#include "CollationSort.h"
+#include "EngineStats.h"
+#include "TrackingAllocator.h"
 
 // Template de classe Hash2Table com parâmetros genéricos para a chave (Key), valor (Value),
 // comparador (COMPARATOR) e função de hash (Hash)
-template <typename Key, typename Value = int, typename COMPARATOR = comparator<Key>, typename Hash = std::hash<Key>>
+template <typename Key, typename Value = int, typename COMPARATOR = comparator<Key>, typename Hash = std::hash<Key>, typename Stats = CountingStats>
 class Hash2Table
 {
 private:
@@ -36,13 +42,19 @@ private:
         Entry() : state(EMPTY) {} // Construtor que inicializa a entrada como vazia
     };
 
+    typedef std::vector<Entry, TrackingAllocator<Entry>> Table; // Vetor de entradas com alocação contada em mem
+
+    static constexpr size_t FIND_BATCH = 16; // Chaves buscadas juntas por find_batch
+
     size_t m_number_of_elements; // Número de elementos inseridos na tabela
+    size_t m_deleted = 0;        // Número de posições marcadas como removidas (ainda ocupam a sequência de sondagem)
     size_t m_table_size;         // Tamanho da tabela de hash (número de buckets)
-    std::vector<Entry> m_table;  // Vetor que representa a tabela de hash
+    Table m_table;               // Vetor que representa a tabela de hash
     float m_load_factor;         // Fator de carga atual da tabela (número de elementos / tamanho da tabela)
     float m_max_load_factor;     // Fator de carga máximo permitido antes de rehashing
     Hash m_hashing;              // Função de hash
-    unsigned int comps = 0;      // Contador de comparações realizadas
+    Stats stats;                 // Contadores de operações e comparações
+    MemoryCounter mem;           // Memória alocada pelo vetor de entradas
     COMPARATOR compare;          // Comparador para ordenar os elementos
 
     // Função privada que retorna o próximo número primo maior ou igual a x
@@ -68,46 +80,108 @@ private:
         return x - 2;
     }
 
-    // Função privada que calcula o código de hash para uma chave e um índice de tentativa (para resolução de colisões)
-    size_t hash_code(const Key &k, size_t i) const
+    // Função privada que procura a chave seguindo a sequência de sondagem até uma posição vazia
+    // Retorna a posição da chave (found = true) ou a posição onde ela deve ser inserida: a primeira
+    // posição removida do caminho ou, se não houver, a posição vazia que encerrou a busca
+    // (m_table_size se a tabela estiver cheia)
+    size_t probe(const Key &k, bool &found)
     {
-        return (m_hashing(k) + i) % m_table_size;
+        return probe(k, m_hashing(k), found);
     }
 
-    // Função privada que imprime os elementos da tabela de hash de forma ordenada
-    void ordered_print()
+    // Mesma busca de probe, a partir do hash da chave já calculado (h = m_hashing(k))
+    size_t probe(const Key &k, size_t h, bool &found)
     {
-        std::vector<std::pair<Key, Value>> elements;
-        elements.reserve(m_number_of_elements); // Reserva espaço para todos os elementos
-
-        // Coleta todos os elementos ocupados da tabela de hash
-        for (size_t i = 0; i < m_table_size; ++i)
+        size_t slot = m_table_size;
+        for (size_t i = 0; i < m_table_size; i++)
         {
-            if (m_table[i].state == OCCUPIED)
+            size_t index = (h + i) % m_table_size;
+            stats.visit();
+            if (m_table[index].state == EMPTY)
             {
-                elements.push_back({m_table[i].key, m_table[i].value});
+                stats.end_search();
+                found = false;
+                return (slot != m_table_size) ? slot : index;
+            }
+            if (m_table[index].state == DELETED)
+            {
+                if (slot == m_table_size)
+                    slot = index;
+                continue;
+            }
+            stats.compare();
+            if (m_table[index].key == k)
+            {
+                stats.end_search();
+                found = true;
+                return index;
             }
         }
+        stats.end_search();
+        found = false;
+        return slot;
+    }
 
-        // Ordena os elementos usando o comparador fornecido
-        std::sort(elements.begin(), elements.end(), [this](const std::pair<Key, Value> &a, const std::pair<Key, Value> &b)
-                  { return compare(a.first, b.first); });
+    // Função privada que reconstrói a tabela com new_size posições, descartando as posições removidas
+    void rebuild(size_t new_size)
+    {
+        typename Stats::Clock start = stats.rehash_begin();
+        Table new_table(new_size, TrackingAllocator<Entry>(&mem));
 
-        // Imprime os elementos ordenados
-        for (const auto &p : elements)
+        for (size_t i = 0; i < m_table_size; i++)
         {
-            if constexpr (std::is_same<Key, icu::UnicodeString>::value)
-            {
-                std::string skey;
-                p.first.toUTF8String(skey);
-                std::cout << skey << ": " << p.second << std::endl;
-            }
-            else
+            if (m_table[i].state == OCCUPIED)
             {
-                std::cout << p.first << ": " << p.second << std::endl;
+                size_t j = 0;
+                size_t index;
+                do
+                {
+                    index = (m_hashing(m_table[i].key) + j++) % new_size; // Recalcula o índice para a nova tabela
+                } while (new_table[index].state == OCCUPIED);
+
+                new_table[index] = m_table[i]; // Move a entrada para a nova tabela
             }
         }
-        std::cout << std::endl;
+
+        m_table = std::move(new_table); // Substitui a tabela antiga pela nova
+        m_table_size = new_size;
+        m_deleted = 0;
+        stats.rehash_end(start);
+    }
+
+    // Função privada que garante espaço para mais um elemento sem passar do fator de carga
+    // As posições removidas contam na carga (alongam as sondagens); se forem a maior parte,
+    // a tabela é apenas reconstruída no mesmo tamanho. Retorna true se a tabela foi reconstruída
+    bool grow()
+    {
+        if (static_cast<float>(m_number_of_elements + m_deleted + 1) / m_table_size <= m_load_factor)
+            return false;
+        if (m_deleted > m_number_of_elements)
+            rebuild(m_table_size);
+        else
+            rehash(2 * m_table_size);
+        return true;
+    }
+
+    // Função privada que ocupa a posição devolvida por probe com uma nova chave
+    Entry &place(size_t index, const Key &k, const Value &v)
+    {
+        if (m_table[index].state == DELETED)
+            m_deleted--;
+        m_table[index].key = k;
+        m_table[index].value = v;
+        m_table[index].state = OCCUPIED;
+        m_number_of_elements++;
+        stats.insert();
+        return m_table[index];
+    }
+
+    // Função privada que imprime os elementos da tabela de hash de forma ordenada
+    void ordered_print(OutputBuffer &out)
+    {
+        for_each([&out](const Key &key, const Value &value)
+                 { out.entry(key, value); });
+        out << '\n';
     }
 
 public:
@@ -117,6 +191,7 @@ public:
 
     // Construtor que inicializa a tabela de hash com um tamanho inicial e outros parâmetros opcionais
     Hash2Table(size_t tableSize = 19, const Hash &hf = Hash(), COMPARATOR comp = COMPARATOR())
+        : m_table(TrackingAllocator<Entry>(&mem))
     {
         compare = comp;
         m_number_of_elements = 0;
@@ -151,6 +226,7 @@ public:
         m_table.clear();
         m_table.resize(m_table_size); // Redimensiona a tabela para o tamanho inicial
         m_number_of_elements = 0;
+        m_deleted = 0;
     }
 
     // Retorna o fator de carga atual
@@ -175,68 +251,63 @@ public:
     bool insert(const Key &k, const Value &v)
     {
         // Verifica se o fator de carga ultrapassou o limite e realiza rehash se necessário
-        if (load_factor() > m_load_factor)
-        {
-            rehash(2 * m_table_size);
-        }
-
-        size_t i = 0;
-        size_t index;
-        do
-        {
-            index = hash_code(k, i++);
-            if (m_table[index].state == EMPTY || m_table[index].state == DELETED)
-            {
-                // Insere nova chave-valor na posição encontrada
-                m_table[index].key = k;
-                m_table[index].value = v;
-                m_table[index].state = OCCUPIED;
-                m_number_of_elements++;
-                return true;
-            }
-            else if (m_table[index].key == k)
-            {
-                comps++;
-                return false;
-            }
-            comps++;
-        } while (i < m_table_size);
-
-        return false; // Retorna falso se não conseguir inserir (caso de tabela cheia)
+        grow();
+
+        bool found;
+        size_t index = probe(k, found);
+        if (found || index == m_table_size)
+            return false; // Chave já existente (ou tabela cheia)
+        place(index, k, v);
+        return true;
     }
 
     // Verifica se uma chave está presente na tabela
     bool contains(const Key &k)
     {
-        size_t i = 0;
-        size_t index;
-        do
-        {
-            index = hash_code(k, i++);
-            if (m_table[index].state == EMPTY)
-                return false;
-            comps++;
-            if (m_table[index].state == OCCUPIED && m_table[index].key == k)
-                return true;
-        } while (i < m_table_size);
-        return false;
+        stats.lookup();
+        bool found;
+        probe(k, found);
+        return found;
     }
 
     // Busca o valor associado a uma chave na tabela
     Value &find(const Key &k)
     {
-        size_t i = 0;
-        size_t index;
-        do
-        {
-            index = hash_code(k, i++);
-            comps++;
-            if (m_table[index].state == OCCUPIED && m_table[index].key == k)
-                return m_table[index].value;
-        } while (i < m_table_size);
-        throw std::out_of_range("Key not found"); // Lança exceção se a chave não for encontrada
+        stats.lookup();
+        bool found;
+        size_t index = probe(k, found);
+        if (!found)
+            throw std::out_of_range("Key not found"); // Lança exceção se a chave não for encontrada
+        return m_table[index].value;
     }
 
+    // Busca n chaves de uma vez: grava em out o valor de cada uma (missing se ausente) e retorna quantas foram encontradas
+    // As chaves são tratadas em grupos de FIND_BATCH: primeiro calcula o hash de todas e pede à cache a
+    // posição inicial de cada uma (__builtin_prefetch), depois faz as sondagens; assim as faltas de cache
+    // do grupo acontecem ao mesmo tempo, em vez de uma depois da outra
+    size_t find_batch(const Key *keys, size_t n, Value *out, const Value &missing = Value())
+    {
+        size_t found = 0;
+        size_t hashes[FIND_BATCH];
+        for (size_t start = 0; start < n; start += FIND_BATCH)
+        {
+            size_t count = std::min(FIND_BATCH, n - start);
+            for (size_t j = 0; j < count; j++)
+            {
+                hashes[j] = m_hashing(keys[start + j]);
+                __builtin_prefetch(&m_table[hashes[j] % m_table_size]);
+            }
+            for (size_t j = 0; j < count; j++)
+            {
+                stats.lookup();
+                bool hit;
+                size_t index = probe(keys[start + j], hashes[j], hit);
+                out[start + j] = hit ? m_table[index].value : missing;
+                found += hit;
+            }
+        }
+        return found;
+    }
 
     // Reorganiza a tabela de hash com um novo tamanho
     void rehash(size_t m)
@@ -244,84 +315,122 @@ public:
         if (m <= m_table_size)
             return;
 
-        size_t new_size = get_next_prime(m); // Obtém o próximo primo para o novo tamanho
-        std::vector<Entry> new_table(new_size);
+        rebuild(get_next_prime(m)); // Obtém o próximo primo para o novo tamanho
+    }
 
-        for (size_t i = 0; i < m_table_size; i++)
+    // Remove um elemento da tabela com base na chave
+    bool remove(const Key &k)
+    {
+        bool found;
+        size_t index = probe(k, found);
+        if (!found)
+            return false;
+        m_table[index].state = DELETED; // Marca a entrada como deletada
+        m_number_of_elements--;
+        m_deleted++;
+        stats.remove();
+        return true;
+    }
+
+    // Atualiza o valor associado a uma chave na tabela
+    bool update(const Key &k, const Value &v)
+    {
+        bool found;
+        size_t index = probe(k, found);
+        if (!found)
+            return false;
+        m_table[index].value = v; // Atualiza o valor da chave
+        stats.update();
+        return true;
+    }
+
+    // Imprime a tabela (por padrão, imprime de forma ordenada)
+    void print()
+    {
+        OutputBuffer out;
+        print(out);
+    }
+
+    // Imprime a tabela em um buffer de saída
+    void print(OutputBuffer &out)
+    {
+        ordered_print(out);
+    }
+
+    // Chama fn(chave, valor) para cada elemento, na ordem da lista impressa
+    // Ordena apenas as posições ocupadas (sem copiar as chaves), pela ordem de collation_order
+    template <typename F>
+    void for_each(F fn) const
+    {
+        std::vector<size_t> slots;
+        slots.reserve(m_number_of_elements); // Reserva espaço para todos os elementos
+
+        // Coleta as posições ocupadas da tabela de hash
+        for (size_t i = 0; i < m_table_size; ++i)
         {
             if (m_table[i].state == OCCUPIED)
             {
-                size_t j = 0;
-                size_t index;
-                do
-                {
-                    index = (m_hashing(m_table[i].key) + j++) % new_size; // Recalcula o índice para a nova tabela
-                } while (new_table[index].state == OCCUPIED);
-
-                new_table[index] = m_table[i]; // Move a entrada para a nova tabela
+                slots.push_back(i);
             }
         }
 
-        m_table = std::move(new_table); // Substitui a tabela antiga pela nova
-        m_table_size = new_size;
+        // Ordena os elementos usando o comparador fornecido
+        std::vector<uint32_t> order = collation_order(slots.size(), [this, &slots](size_t i) -> const Key &
+                                                      { return m_table[slots[i]].key; }, compare);
+
+        for (uint32_t i : order)
+        {
+            fn(m_table[slots[i]].key, m_table[slots[i]].value);
+        }
     }
 
-    // Remove um elemento da tabela com base na chave
-    bool remove(const Key &k)
+    // Retorna as k chaves de maior valor, da maior para a menor (sem ordenar a tabela inteira)
+    std::vector<std::pair<Key, Value>> top_k(size_t k) const
     {
-        size_t i = 0;
-        size_t index;
-        do
+        TopK<Key, Value, COMPARATOR> top(k, compare);
+        for (size_t i = 0; i < m_table_size; ++i)
         {
-            index = hash_code(k, i++);
-            if (m_table[index].state == EMPTY)
-                return false;
-            if (m_table[index].state == OCCUPIED && m_table[index].key == k)
+            if (m_table[i].state == OCCUPIED)
             {
-                m_table[index].state = DELETED; // Marca a entrada como deletada
-                m_number_of_elements--;
-                return true;
+                top.offer(m_table[i].key, m_table[i].value);
             }
-        } while (i < m_table_size);
-        return false;
+        }
+        return top.result();
     }
 
-    // Atualiza o valor associado a uma chave na tabela
-    bool update(const Key &k, const Value &v)
+    // Retorna o número de comparações realizadas
+    size_t comparisons()
     {
-        size_t i = 0;
-        size_t index;
-        do
-        {
-            index = hash_code(k, i++);
-            comps++;
-            if (m_table[index].state == OCCUPIED && m_table[index].key == k)
-            {
-                m_table[index].value = v; // Atualiza o valor da chave
-                return true;
-            }
-        } while (i < m_table_size);
-        return false;
+        return stats.comparisons();
     }
 
-    // Imprime a tabela (por padrão, imprime de forma ordenada)
-    void print()
+    // Retorna as estatísticas da tabela (contadores, fator de carga e posições removidas)
+    EngineStats statistics() const
     {
-        ordered_print();
+        EngineStats s = stats.counters();
+        s.layout = EngineLayout::OpenAddressing;
+        s.buckets = m_table_size;
+        s.load_factor = static_cast<double>(m_number_of_elements) / m_table_size;
+        s.tombstones = m_deleted;
+        s.tombstone_ratio = static_cast<double>(m_deleted) / m_table_size;
+        s.size = m_number_of_elements;
+        return s;
     }
 
-    // Retorna o número de comparações realizadas
-    size_t comparisons()
+    // Retorna a memória ocupada pela tabela (posições, chaves e valores)
+    // As posições vazias ou removidas contam como estrutura
+    MemoryUsage memory() const
     {
-        return comps;
+        return mem.usage(m_number_of_elements, sizeof(Key), sizeof(Value));
     }
 
     // Garante que a tabela tenha espaço suficiente para um certo número de elementos
+    // (sem ultrapassar o fator de carga, então as n inserções não causam nenhum rehash)
     void reserve(size_t n)
     {
         if (n > m_table_size * m_load_factor)
         {
-            rehash(n);
+            rehash(static_cast<size_t>(std::ceil(n / m_load_factor)) + 1);
         }
     }
 
@@ -339,43 +448,19 @@ public:
     // Operador de índice para acessar ou criar elementos na tabela
     Value &operator[](const Key &k)
     {
-        size_t i = 0;
-        size_t index;
-        do
-        {
-            index = hash_code(k, i++);
-            if (m_table[index].state == EMPTY)
-            {
-                m_table[index].key = k;
-                m_table[index].value = Value();
-                m_table[index].state = OCCUPIED;
-                m_number_of_elements++;
-                return m_table[index].value;
-            }
-            else if (m_table[index].key == k)
-            {
-                comps++;
-                return m_table[index].value;
-            }
-        } while (i < m_table_size);
-        throw std::out_of_range("Key not found");
-    }
-
-    // Operador de índice const para acessar elementos na tabela
-    // const Value &operator[](const Key &k) const
-    // {
-    //     size_t i = 0;
-    //     size_t index;
-    //     do
-    //     {
-    //         index = hash_code(k, i++);
-    //         if (m_table[index].state == OCCUPIED && m_table[index].key == k)
-    //         {
-    //             return m_table[index].value;
-    //         }
-    //     } while (i < m_table_size);
-    //     throw std::out_of_range("Key not found"); // Lança exceção se a chave não for encontrada
-    // }
+        stats.lookup();
+        bool found;
+        size_t index = probe(k, found);
+        if (found)
+            return m_table[index].value;
+
+        // Chave nova: garante espaço antes de criá-la (o rehash muda as posições)
+        if (grow())
+            index = probe(k, found);
+        if (index == m_table_size)
+            throw std::out_of_range("Key not found");
+        return place(index, k, Value()).value;
+    }
 };
 
 #endif
@@ -0,0 +1,30 @@
+#ifndef HASH64_H
+#define HASH64_H
+
+#include <cstdint>
+#include <string_view>
+
+// Hash FNV-1a de 64 bits dos bytes, continuando a partir de um estado (sem mistura final)
+inline uint64_t fnv1a64(std::string_view s, uint64_t h = 14695981039346656037ull)
+{
+    for (unsigned char c : s)
+    {
+        h ^= c;
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+// Hash FNV-1a de 64 bits dos bytes UTF-8, com mistura final para espalhar os bits
+// (os estimadores usam partes diferentes do hash como se fossem hashes independentes)
+// A semente muda o estado inicial: sem conhecê-la, não dá para escolher palavras que colidem
+inline uint64_t hash64(std::string_view s, uint64_t seed = 0)
+{
+    uint64_t h = fnv1a64(s, 14695981039346656037ull ^ seed);
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    return h;
+}
+
+#endif
@@ -0,0 +1,111 @@
+#ifndef HYPERLOGLOG_H
+#define HYPERLOGLOG_H
+
+#include <iostream>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unicode/unistr.h>
+#include "extras.h"
+
+// Estimador HyperLogLog do número de palavras distintas
+// Usa 2^precision registradores de 1 byte (4 KB com a precisão padrão, 12): os primeiros bits do
+// hash da palavra escolhem o registrador, que guarda a maior posição do primeiro bit 1 vista no
+// resto do hash. O erro padrão é 1.04 / sqrt(2^precision) (1.6% com a precisão padrão), sem
+// depender do número de palavras; para poucas palavras usa contagem linear dos registradores zerados
+class HyperLogLog
+{
+private:
+    unsigned int m_precision;        // Bits do hash que escolhem o registrador
+    std::vector<uint8_t> m_registers; // Registradores
+
+public:
+    HyperLogLog(unsigned int precision = 12) : m_precision(precision)
+    {
+        if (m_precision < 4 || m_precision > 18)
+            throw std::out_of_range("out of range precision");
+        m_registers.assign(size_t(1) << m_precision, 0);
+    }
+
+    // Adiciona uma palavra UTF-8
+    void add(std::string_view word)
+    {
+        add_hash(hash64(word));
+    }
+
+    // Adiciona uma palavra pelo seu hash64 (quando ele já foi calculado para outro uso)
+    void add_hash(uint64_t h)
+    {
+        size_t index = h >> (64 - m_precision);
+        uint64_t rest = h << m_precision;
+        uint8_t rank = (rest == 0) ? static_cast<uint8_t>(64 - m_precision + 1) : static_cast<uint8_t>(__builtin_clzll(rest) + 1);
+        if (m_registers[index] < rank)
+            m_registers[index] = rank;
+    }
+
+    // Adiciona uma palavra icu::UnicodeString
+    void add(const icu::UnicodeString &word)
+    {
+        std::string utf8;
+        word.toUTF8String(utf8);
+        add(std::string_view(utf8));
+    }
+
+    // Número estimado de palavras distintas adicionadas
+    size_t estimate() const
+    {
+        double m = static_cast<double>(m_registers.size());
+        double sum = 0;
+        size_t zeros = 0;
+        for (uint8_t r : m_registers)
+        {
+            sum += std::ldexp(1.0, -r);
+            if (r == 0)
+                zeros++;
+        }
+        double alpha = 0.7213 / (1 + 1.079 / m);
+        double e = alpha * m * m / sum;
+        if (e <= 2.5 * m && zeros > 0)
+            e = m * std::log(m / zeros); // Correção para poucas palavras (contagem linear)
+        return static_cast<size_t>(std::llround(e));
+    }
+
+    // Junta outro estimador de mesma precisão (o resultado estima a união das palavras)
+    void merge(const HyperLogLog &other)
+    {
+        if (other.m_precision != m_precision)
+            throw std::invalid_argument("precision mismatch");
+        for (size_t i = 0; i < m_registers.size(); i++)
+        {
+            if (m_registers[i] < other.m_registers[i])
+                m_registers[i] = other.m_registers[i];
+        }
+    }
+
+    void clear()
+    {
+        std::fill(m_registers.begin(), m_registers.end(), 0);
+    }
+
+    // Erro padrão relativo da estimativa
+    double standard_error() const
+    {
+        return 1.04 / std::sqrt(static_cast<double>(m_registers.size()));
+    }
+
+    unsigned int precision() const
+    {
+        return m_precision;
+    }
+
+    // Memória dos registradores, em bytes
+    size_t bytes() const
+    {
+        return m_registers.size();
+    }
+};
+
+#endif
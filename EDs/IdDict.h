@@ -0,0 +1,280 @@
+#ifndef IDDICT_H
+#define IDDICT_H
+
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Dict.h"
+#include "CollationSort.h"
+
+// Dicionário de IDs densos
+// A estrutura (qualquer uma das engines) serve apenas de índice palavra -> ID, atribuído na primeira
+// ocorrência da palavra (0, 1, 2, ...). As frequências ficam em um vetor indexado pelo ID, então as
+// ocorrências repetidas só incrementam uma posição do vetor, sem alterar a estrutura. Opcionalmente
+// guarda também o texto como uma sequência de IDs (para n-gramas e coocorrências).
+// Não é seguro entre threads
+template <typename EDType>
+class IdDict
+{
+private:
+    typedef typename key_of<EDType>::type Key;
+    typedef typename comparator_of<EDType>::type Comparator;
+
+    KeyArena _arena;                // Arena das palavras (usada apenas quando a estrutura guarda WordRef)
+    EDType _index;                  // Índice palavra -> ID + 1 (0 é o valor padrão das estruturas, "sem ID")
+    std::vector<uint32_t> _counts;  // Frequência de cada ID
+    std::vector<Key> _words;        // Palavra de cada ID
+    std::vector<uint32_t> _tokens;  // Sequência de IDs do texto (se habilitada)
+    bool _record = false;           // Indica se a sequência de IDs deve ser guardada
+    size_t _live = 0;               // Número de IDs com frequência maior que zero
+    Comparator _compare;            // Comparador da ordem das palavras (criado uma única vez)
+
+    // Procura o ID de uma chave na estrutura sem criá-lo; retorna UINT32_MAX se a chave não tiver ID
+    uint32_t _lookup(const Key &key)
+    {
+        if (missing_key(key) || !_index.contains(key))
+            return UINT32_MAX;
+        return static_cast<uint32_t>(_index.find(key)) - 1;
+    }
+
+    // Atribui o próximo ID a uma chave nova
+    uint32_t _assign(const Key &key)
+    {
+        _words.push_back(key);
+        _counts.push_back(0);
+        return static_cast<uint32_t>(_words.size() - 1);
+    }
+
+public:
+    // Habilita (ou desabilita) a gravação da sequência de IDs do texto
+    void record_tokens(bool record)
+    {
+        _record = record;
+    }
+
+    // Soma value à frequência da palavra e retorna o seu ID (atribuindo um novo ID na primeira ocorrência)
+    template <typename Word>
+    uint32_t add(const Word &word, unsigned int value = 1)
+    {
+        Key key = make_key<Key>(_arena, word, true);
+        uint32_t id;
+        if constexpr (has_add<EDType>::value)
+        {
+            id = static_cast<uint32_t>(_index.find(key)) - 1;
+            if (id == UINT32_MAX)
+            {
+                id = _assign(key);
+                _index.insert(key, id + 1);
+            }
+        }
+        else
+        {
+            try
+            {
+                auto &stored = _index[key];
+                if (stored == 0)
+                {
+                    // Hash2Table cria a entrada (com valor 0) no próprio operator[]
+                    id = _assign(key);
+                    stored = id + 1;
+                }
+                else
+                    id = static_cast<uint32_t>(stored) - 1;
+            }
+            catch (std::out_of_range &e)
+            {
+                id = _assign(key);
+                _index.insert(key, id + 1);
+            }
+        }
+        if (_counts[id] == 0)
+            _live++;
+        _counts[id] += value;
+        if (_record)
+            _tokens.push_back(id);
+        return id;
+    }
+
+    // Diminui em 1 a frequência da palavra (o ID continua reservado para ela)
+    template <typename Word>
+    void remove(const Word &word)
+    {
+        uint32_t id = _lookup(make_key<Key>(_arena, word, false));
+        if (id == UINT32_MAX || _counts[id] == 0)
+        {
+            std::cerr << "Key not found" << std::endl;
+            return;
+        }
+        if (--_counts[id] == 0)
+            _live--;
+    }
+
+    // Define a frequência de uma palavra que já tem ID
+    template <typename Word>
+    void update(const Word &word, unsigned int value)
+    {
+        uint32_t id = _lookup(make_key<Key>(_arena, word, false));
+        if (id == UINT32_MAX)
+            return;
+        if (_counts[id] == 0 && value != 0)
+            _live++;
+        else if (_counts[id] != 0 && value == 0)
+            _live--;
+        _counts[id] = value;
+    }
+
+    // Retorna a frequência da palavra (0 se ela não existir)
+    template <typename Word>
+    int find(const Word &word)
+    {
+        uint32_t id = _lookup(make_key<Key>(_arena, word, false));
+        return (id == UINT32_MAX) ? 0 : _counts[id];
+    }
+
+    // Retorna o ID da palavra, ou UINT32_MAX se ela nunca foi vista
+    template <typename Word>
+    uint32_t id(const Word &word)
+    {
+        return _lookup(make_key<Key>(_arena, word, false));
+    }
+
+    // Retorna a palavra de um ID
+    const Key &word(uint32_t id) const
+    {
+        return _words[id];
+    }
+
+    // Retorna a frequência de um ID
+    uint32_t count(uint32_t id) const
+    {
+        return _counts[id];
+    }
+
+    // Retorna a sequência de IDs do texto (vazia se a gravação não foi habilitada)
+    const std::vector<uint32_t> &tokens() const
+    {
+        return _tokens;
+    }
+
+    // Número de IDs atribuídos (incluindo os que tiveram a frequência zerada)
+    size_t ids() const
+    {
+        return _words.size();
+    }
+
+    // Prepara o índice e os vetores de IDs para n palavras distintas
+    void reserve(size_t n)
+    {
+        if constexpr (has_reserve<EDType>::value)
+            _index.reserve(n);
+        _counts.reserve(n);
+        _words.reserve(n);
+    }
+
+    void clear()
+    {
+        _index.clear();
+        _counts.clear();
+        _words.clear();
+        _tokens.clear();
+        _arena.clear();
+        _live = 0;
+    }
+
+    template <typename Word>
+    bool contains(const Word &word)
+    {
+        uint32_t id = _lookup(make_key<Key>(_arena, word, false));
+        return id != UINT32_MAX && _counts[id] > 0;
+    }
+
+    size_t size()
+    {
+        return _live;
+    }
+
+    size_t comparisons()
+    {
+        return _index.comparisons();
+    }
+
+    // Memória do índice, da arena e dos vetores de IDs (sem a sequência de IDs do texto)
+    // Os IDs guardados no índice contam como estrutura; os valores são as frequências
+    MemoryUsage memory() const
+    {
+        MemoryUsage m = _index.memory();
+        m.structure += m.values;
+        m.values = _counts.capacity() * sizeof(uint32_t);
+        m.keys += _arena.used() + _words.capacity() * sizeof(Key);
+        return m;
+    }
+
+    // Estatísticas do índice palavra -> ID
+    EngineStats statistics() const
+    {
+        return _index.statistics();
+    }
+
+    // Imprime as palavras em ordem com as suas frequências
+    void print()
+    {
+        OutputBuffer out;
+        print(out);
+    }
+
+    // Imprime as palavras em ordem com as suas frequências em um buffer de saída
+    void print(OutputBuffer &out)
+    {
+        std::vector<uint32_t> live;
+        live.reserve(_live);
+        for (uint32_t id = 0; id < _words.size(); id++)
+        {
+            if (_counts[id] > 0)
+                live.push_back(id);
+        }
+        std::vector<uint32_t> order = collation_order(live.size(), [this, &live](size_t i) -> const Key &
+                                                      { return _words[live[i]]; }, _compare);
+        for (uint32_t i : order)
+        {
+            out.entry(_words[live[i]], _counts[live[i]]);
+        }
+    }
+
+    // Retorna as k palavras mais frequentes, da mais frequente para a menos frequente
+    // Seleciona direto sobre o vetor de frequências, sem consultar a estrutura
+    std::vector<std::pair<Key, uint32_t>> top_k(size_t k)
+    {
+        TopK<Key, uint32_t, Comparator> top(k, _compare);
+        for (uint32_t id = 0; id < _words.size(); id++)
+        {
+            if (_counts[id] > 0)
+                top.offer(_words[id], _counts[id]);
+        }
+        return top.result();
+    }
+
+    // Grava a sequência de IDs do texto como inteiros de 32 bits (na ordem de bytes da máquina)
+    bool save_tokens(const std::string &path) const
+    {
+        std::ofstream file(path, std::ios::binary);
+        file.write(reinterpret_cast<const char *>(_tokens.data()), _tokens.size() * sizeof(uint32_t));
+        return static_cast<bool>(file);
+    }
+
+    // Grava o vocabulário, uma palavra por linha, na ordem dos IDs
+    bool save_vocab(const std::string &path) const
+    {
+        std::ofstream file(path, std::ios::binary);
+        {
+            OutputBuffer out(file);
+            for (const Key &key : _words)
+                out << key << '\n';
+        }
+        return static_cast<bool>(file);
+    }
+};
+
+#endif
@@ -0,0 +1,286 @@
+#ifndef KEYARENA_H
+#define KEYARENA_H
+
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <cstdint>
+#include <cstring>
+#include "Hash64.h"
+
+// Referência (8 bytes) para uma palavra internada em uma KeyArena
+// Aponta para um registro [tamanho: uint32][hash: uint32][bytes UTF-8] guardado na arena.
+// Como cada palavra distinta é guardada uma única vez, duas referências são iguais se e
+// somente se apontam para o mesmo registro, então a igualdade é uma comparação de ponteiros
+class WordRef
+{
+private:
+    const char *m_ptr; // Início do registro na arena (nullptr para a referência vazia)
+
+public:
+    WordRef() : m_ptr(nullptr) {}
+    explicit WordRef(const char *record) : m_ptr(record) {}
+
+    // Número de bytes UTF-8 da palavra
+    uint32_t length() const
+    {
+        uint32_t len = 0;
+        if (m_ptr != nullptr)
+            std::memcpy(&len, m_ptr, sizeof(len));
+        return len;
+    }
+
+    // Hash FNV-1a de 32 bits dos bytes UTF-8, continuando a partir de um estado (o de WordRef::hash)
+    static uint32_t hash_of(std::string_view s, uint32_t h = 2166136261u)
+    {
+        for (unsigned char c : s)
+        {
+            h ^= c;
+            h *= 16777619u;
+        }
+        return h;
+    }
+
+    // Hash da palavra (hash_of, usado pelas tabelas de hash), calculado uma única vez ao internar
+    uint32_t hash() const
+    {
+        uint32_t h = 0;
+        if (m_ptr != nullptr)
+            std::memcpy(&h, m_ptr + sizeof(uint32_t), sizeof(h));
+        return h;
+    }
+
+    // Bytes UTF-8 da palavra (sem terminador)
+    const char *data() const
+    {
+        return (m_ptr == nullptr) ? "" : m_ptr + 2 * sizeof(uint32_t);
+    }
+
+    // Visão da palavra como string UTF-8
+    std::string_view view() const
+    {
+        return std::string_view(data(), length());
+    }
+
+    // Verifica se a referência é vazia (palavra não internada)
+    bool null() const
+    {
+        return m_ptr == nullptr;
+    }
+
+    bool operator==(const WordRef &other) const { return m_ptr == other.m_ptr; }
+    bool operator!=(const WordRef &other) const { return m_ptr != other.m_ptr; }
+
+    // Ordem pelos bytes UTF-8 (usada pelo comparador genérico; a ordem alfabética vem do u_comparator)
+    bool operator<(const WordRef &other) const { return view() < other.view(); }
+    bool operator>(const WordRef &other) const { return other < *this; }
+
+    // Escreve a palavra diretamente a partir da arena
+    friend std::ostream &operator<<(std::ostream &os, const WordRef &w)
+    {
+        return os.write(w.data(), w.length());
+    }
+};
+
+namespace std
+{
+    template <>
+    struct hash<WordRef>
+    {
+        size_t operator()(const WordRef &w) const
+        {
+            return static_cast<size_t>(w.hash());
+        }
+    };
+}
+
+// Arena de internação de palavras
+// Guarda cada palavra distinta uma única vez, em blocos contíguos que só crescem (os registros
+// nunca mudam de endereço, então as WordRef continuam válidas enquanto a arena existir).
+// A arena é dividida em fatias, cada uma com a sua trava, para que várias threads
+// tokenizadoras possam internar palavras ao mesmo tempo.
+// A tabela da arena usa um hash de 64 bits com semente sorteada por arena, separado do hash
+// guardado no registro (o das estruturas): palavras escolhidas para colidir no hash das
+// estruturas não colidem na arena, e não dá para escolhê-las sem conhecer a semente
+class KeyArena
+{
+private:
+    static const size_t SHARDS = 16;          // Número de fatias (potência de 2)
+    static const size_t BLOCK_SIZE = 1 << 16; // Tamanho de cada bloco de registros
+
+    // Fatia da arena: blocos de registros e tabela de hash (endereçamento aberto) para encontrá-los
+    struct Shard
+    {
+        mutable std::mutex lock;
+        std::vector<std::unique_ptr<char[]>> blocks; // Blocos alocados
+        size_t used = 0;                             // Bytes usados no último bloco
+        size_t capacity = 0;                         // Capacidade do último bloco
+        size_t bytes = 0;                            // Bytes alocados em blocos
+        std::vector<const char *> table;             // Registros indexados pelo hash
+        size_t count = 0;                            // Número de palavras na fatia
+    };
+
+    Shard m_shards[SHARDS];
+    uint64_t m_seed; // Semente do hash da tabela
+
+    // Procura a palavra na tabela da fatia, retornando a posição onde ela está ou deveria estar
+    static size_t probe(const Shard &shard, std::string_view s, uint64_t h)
+    {
+        size_t mask = shard.table.size() - 1;
+        size_t i = (h >> 4) & mask;
+        while (shard.table[i] != nullptr)
+        {
+            if (WordRef(shard.table[i]).view() == s)
+                return i;
+            i = (i + 1) & mask;
+        }
+        return i;
+    }
+
+    // Dobra a tabela da fatia, reinserindo os registros existentes
+    static void grow(Shard &shard, uint64_t seed)
+    {
+        std::vector<const char *> old = std::move(shard.table);
+        shard.table.assign(old.empty() ? 64 : old.size() * 2, nullptr);
+        size_t mask = shard.table.size() - 1;
+        for (const char *record : old)
+        {
+            if (record == nullptr)
+                continue;
+            size_t i = (hash64(WordRef(record).view(), seed) >> 4) & mask;
+            while (shard.table[i] != nullptr)
+                i = (i + 1) & mask;
+            shard.table[i] = record;
+        }
+    }
+
+    // Copia a palavra para o fim do último bloco da fatia (ou para um bloco novo)
+    static const char *append(Shard &shard, std::string_view s)
+    {
+        uint32_t h = WordRef::hash_of(s);
+        size_t need = 2 * sizeof(uint32_t) + s.size();
+        need = (need + 3) & ~size_t(3); // Mantém os registros alinhados a 4 bytes
+        if (shard.used + need > shard.capacity)
+        {
+            size_t size = (need > BLOCK_SIZE) ? need : BLOCK_SIZE;
+            shard.blocks.emplace_back(new char[size]);
+            shard.used = 0;
+            shard.capacity = size;
+            shard.bytes += size;
+        }
+        char *record = shard.blocks.back().get() + shard.used;
+        uint32_t len = static_cast<uint32_t>(s.size());
+        std::memcpy(record, &len, sizeof(len));
+        std::memcpy(record + sizeof(len), &h, sizeof(h));
+        std::memcpy(record + 2 * sizeof(uint32_t), s.data(), s.size());
+        shard.used += need;
+        return record;
+    }
+
+public:
+    KeyArena() : m_seed((static_cast<uint64_t>(std::random_device()()) << 32) ^ std::random_device()()) {}
+
+    // Desabilita a cópia da arena (as WordRef apontam para a memória dela)
+    KeyArena(const KeyArena &a) = delete;
+    KeyArena &operator=(const KeyArena &a) = delete;
+
+    // Interna uma palavra UTF-8, retornando a referência única para ela
+    WordRef intern(std::string_view s)
+    {
+        uint64_t h = hash64(s, m_seed);
+        Shard &shard = m_shards[h & (SHARDS - 1)];
+        std::lock_guard<std::mutex> guard(shard.lock);
+        if (2 * (shard.count + 1) > shard.table.size())
+            grow(shard, m_seed);
+        size_t i = probe(shard, s, h);
+        if (shard.table[i] == nullptr)
+        {
+            shard.table[i] = append(shard, s);
+            shard.count++;
+        }
+        return WordRef(shard.table[i]);
+    }
+
+    // Procura uma palavra sem interná-la; retorna uma referência vazia se ela nunca foi vista
+    WordRef lookup(std::string_view s) const
+    {
+        uint64_t h = hash64(s, m_seed);
+        const Shard &shard = m_shards[h & (SHARDS - 1)];
+        std::lock_guard<std::mutex> guard(shard.lock);
+        if (shard.table.empty())
+            return WordRef();
+        return WordRef(shard.table[probe(shard, s, h)]);
+    }
+
+    // Descarta todas as palavras, liberando os blocos e as tabelas (as WordRef obtidas antes deixam de ser válidas)
+    void clear()
+    {
+        for (Shard &shard : m_shards)
+        {
+            std::lock_guard<std::mutex> guard(shard.lock);
+            shard.blocks.clear();
+            shard.used = 0;
+            shard.capacity = 0;
+            shard.bytes = 0;
+            std::vector<const char *>().swap(shard.table);
+            shard.count = 0;
+        }
+    }
+
+    // Chama fn(WordRef) para cada palavra internada (em nenhuma ordem em particular)
+    template <typename F>
+    void for_each(F fn) const
+    {
+        for (const Shard &shard : m_shards)
+        {
+            std::lock_guard<std::mutex> guard(shard.lock);
+            for (const char *record : shard.table)
+            {
+                if (record != nullptr)
+                    fn(WordRef(record));
+            }
+        }
+    }
+
+    // Número de palavras distintas internadas
+    size_t size() const
+    {
+        size_t n = 0;
+        for (const Shard &shard : m_shards)
+        {
+            std::lock_guard<std::mutex> guard(shard.lock);
+            n += shard.count;
+        }
+        return n;
+    }
+
+    // Memória ocupada pelos registros e tabelas, em bytes (sem a parte ainda livre do último bloco de cada fatia)
+    size_t used() const
+    {
+        size_t n = 0;
+        for (const Shard &shard : m_shards)
+        {
+            std::lock_guard<std::mutex> guard(shard.lock);
+            n += shard.bytes - (shard.capacity - shard.used) + shard.table.capacity() * sizeof(const char *);
+        }
+        return n;
+    }
+
+    // Memória usada pela arena (blocos de registros e tabelas), em bytes
+    size_t bytes() const
+    {
+        size_t n = 0;
+        for (const Shard &shard : m_shards)
+        {
+            std::lock_guard<std::mutex> guard(shard.lock);
+            n += shard.bytes + shard.table.capacity() * sizeof(const char *);
+        }
+        return n;
+    }
+};
+
+#endif
@@ -0,0 +1,244 @@
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include "OutputBuffer.h"
+
+// Histograma de latências em nanossegundos, no estilo HDR: cada potência de 2 é dividida em
+// SUB posições lineares, então o erro relativo de qualquer valor é de no máximo 1 / SUB (~3%)
+// em toda a faixa de 1ns até 2^64ns, com memória fixa e registro em tempo constante
+class LatencyHistogram
+{
+public:
+    static const unsigned SUB_BITS = 5;
+    static const size_t SUB = size_t(1) << SUB_BITS;    // Posições por potência de 2
+    static const size_t BUCKETS = (64 - SUB_BITS + 1) * SUB; // Número de posições
+
+private:
+    std::vector<uint64_t> m_counts;
+    uint64_t m_total = 0; // Número de amostras
+    uint64_t m_sum = 0;   // Soma das latências
+    uint64_t m_max = 0;   // Maior latência
+
+public:
+    LatencyHistogram() : m_counts(BUCKETS, 0) {}
+
+    // Posição do histograma de uma latência
+    // Até SUB os valores são exatos; acima, os SUB_BITS bits mais significativos escolhem a posição
+    static size_t bucket(uint64_t ns)
+    {
+        if (ns < SUB)
+            return static_cast<size_t>(ns);
+        unsigned shift = (63 - __builtin_clzll(ns)) - SUB_BITS;
+        return (shift + 1) * SUB + static_cast<size_t>((ns >> shift) - SUB);
+    }
+
+    // Maior latência da posição b
+    static uint64_t upper(size_t b)
+    {
+        if (b < SUB)
+            return b;
+        unsigned shift = static_cast<unsigned>(b / SUB - 1);
+        uint64_t sub = SUB + b % SUB;
+        return ((sub + 1) << shift) - 1;
+    }
+
+    void record(uint64_t ns)
+    {
+        m_counts[bucket(ns)]++;
+        m_total++;
+        m_sum += ns;
+        if (ns > m_max)
+            m_max = ns;
+    }
+
+    // Soma as amostras de outro histograma (de outra thread, por exemplo)
+    void merge(const LatencyHistogram &other)
+    {
+        for (size_t b = 0; b < BUCKETS; b++)
+            m_counts[b] += other.m_counts[b];
+        m_total += other.m_total;
+        m_sum += other.m_sum;
+        if (other.m_max > m_max)
+            m_max = other.m_max;
+    }
+
+    uint64_t total() const { return m_total; }
+    uint64_t max() const { return m_max; }
+
+    double mean() const
+    {
+        return m_total == 0 ? 0.0 : static_cast<double>(m_sum) / m_total;
+    }
+
+    // Percentil p (0 a 100): maior latência da posição onde está a amostra de posto ceil(p * total)
+    // Nunca passa da maior latência registrada
+    uint64_t percentile(double p) const
+    {
+        if (m_total == 0)
+            return 0;
+        uint64_t rank = static_cast<uint64_t>(std::ceil(p / 100 * m_total));
+        if (rank == 0)
+            rank = 1;
+        uint64_t seen = 0;
+        for (size_t b = 0; b < BUCKETS; b++)
+        {
+            seen += m_counts[b];
+            if (seen >= rank)
+                return upper(b) < m_max ? upper(b) : m_max;
+        }
+        return m_max;
+    }
+
+    // Imprime os percentis em uma linha ("n=..., p50 ..., ..., max ...")
+    void print(OutputBuffer &out) const
+    {
+        out << "n=" << m_total << ", p50 " << percentile(50) << ", p90 " << percentile(90) << ", p99 " << percentile(99)
+            << ", p99.9 " << percentile(99.9) << ", max " << m_max;
+    }
+
+    // Grava em JSON (um objeto, sem quebra de linha)
+    void write_json(std::ostream &os) const
+    {
+        os << "{\"count\": " << m_total << ", \"mean\": " << mean() << ", \"p50\": " << percentile(50)
+           << ", \"p90\": " << percentile(90) << ", \"p99\": " << percentile(99) << ", \"p99.9\": " << percentile(99.9)
+           << ", \"max\": " << m_max << "}";
+    }
+};
+
+// Operações medidas pelo LatencyRecorder
+enum class LatencyOp
+{
+    Add,    // Soma à frequência (inserção)
+    Find,   // Consulta da frequência
+    Remove, // Remoção
+    Update, // Troca da frequência
+    Count   // Número de operações
+};
+
+// Latências por operação de uma estrutura, com amostragem
+// Com every = N, uma operação em cada N (em média) é medida; as posições sorteadas evitam coincidir
+// com padrões periódicos da carga (como um rehash a cada potência de 2). Com every = 1 todas são medidas.
+// Não é seguro entre threads: cada thread usa o seu e os resultados são somados com merge
+class LatencyRecorder
+{
+private:
+    LatencyHistogram m_ops[static_cast<int>(LatencyOp::Count)];
+    uint32_t m_every;     // Taxa de amostragem (1 em every)
+    uint32_t m_skip = 0;  // Operações que ainda faltam pular até a próxima amostra
+    uint64_t m_rng;       // Estado do sorteio das amostras (xorshift)
+
+public:
+    explicit LatencyRecorder(uint32_t every = 1, uint64_t seed = 88172645463325252ull)
+        : m_every(every == 0 ? 1 : every), m_rng(seed == 0 ? 1 : seed)
+    {
+    }
+
+    // Decide se a próxima operação é medida
+    // Entre duas amostras pula um número sorteado entre 0 e 2 * (every - 1) operações (média every - 1)
+    bool sample()
+    {
+        if (m_every == 1)
+            return true;
+        if (m_skip > 0)
+        {
+            m_skip--;
+            return false;
+        }
+        m_rng ^= m_rng << 13;
+        m_rng ^= m_rng >> 7;
+        m_rng ^= m_rng << 17;
+        m_skip = static_cast<uint32_t>(m_rng % (2 * uint64_t(m_every) - 1));
+        return true;
+    }
+
+    void record(LatencyOp op, uint64_t ns)
+    {
+        m_ops[static_cast<int>(op)].record(ns);
+    }
+
+    const LatencyHistogram &operator[](LatencyOp op) const
+    {
+        return m_ops[static_cast<int>(op)];
+    }
+
+    uint32_t every() const
+    {
+        return m_every;
+    }
+
+    void merge(const LatencyRecorder &other)
+    {
+        for (int o = 0; o < static_cast<int>(LatencyOp::Count); o++)
+            m_ops[o].merge(other.m_ops[o]);
+    }
+
+    // Nome da operação (na saída e no JSON)
+    static const char *name(LatencyOp op)
+    {
+        static const char *names[] = {"add", "find", "remove", "update"};
+        return names[static_cast<int>(op)];
+    }
+
+    // Imprime uma linha por operação medida
+    void print(OutputBuffer &out, const char *indent = "  ") const
+    {
+        for (int o = 0; o < static_cast<int>(LatencyOp::Count); o++)
+        {
+            if (m_ops[o].total() == 0)
+                continue;
+            out << indent << name(static_cast<LatencyOp>(o)) << ": ";
+            m_ops[o].print(out);
+            out << '\n';
+        }
+    }
+
+    // Grava em JSON ({"sample_every": N, "add": {...}, ...}, só as operações medidas)
+    void write_json(std::ostream &os) const
+    {
+        os << "{\"sample_every\": " << m_every;
+        for (int o = 0; o < static_cast<int>(LatencyOp::Count); o++)
+        {
+            if (m_ops[o].total() == 0)
+                continue;
+            os << ", \"" << name(static_cast<LatencyOp>(o)) << "\": ";
+            m_ops[o].write_json(os);
+        }
+        os << "}";
+    }
+};
+
+// Mede a latência de uma operação (o tempo de vida do escopo) e registra no LatencyRecorder
+// Com recorder nulo ou fora da amostra o relógio não é lido
+class ScopedLatency
+{
+private:
+    LatencyRecorder *m_recorder;
+    LatencyOp m_op;
+    std::chrono::steady_clock::time_point m_start;
+
+public:
+    ScopedLatency(LatencyRecorder *recorder, LatencyOp op) : m_recorder(recorder), m_op(op)
+    {
+        if (m_recorder != nullptr && !m_recorder->sample())
+            m_recorder = nullptr;
+        if (m_recorder != nullptr)
+            m_start = std::chrono::steady_clock::now();
+    }
+
+    ~ScopedLatency()
+    {
+        if (m_recorder != nullptr)
+            m_recorder->record(m_op, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_start).count());
+    }
+
+    // Desabilita a cópia do medidor
+    ScopedLatency(const ScopedLatency &t) = delete;
+    ScopedLatency &operator=(const ScopedLatency &t) = delete;
+};
+
+#endif
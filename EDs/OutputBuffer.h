@@ -0,0 +1,138 @@
+#ifndef OUTPUTBUFFER_H
+#define OUTPUTBUFFER_H
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <charconv>
+#include <type_traits>
+#include <unicode/unistr.h>
+#include "KeyArena.h"
+
+// Saída com buffer grande, usada por todas as estruturas para imprimir as palavras
+// Os bytes são acumulados em um buffer reutilizável e enviados ao streambuf de destino em blocos
+// grandes (poucas chamadas de write()), sem o flush por linha de std::endl. Os números são
+// formatados com std::to_chars e as palavras internadas são copiadas direto da arena
+class OutputBuffer
+{
+private:
+    std::streambuf *m_dest;   // Destino dos bytes (por exemplo, o arquivo para onde cout foi redirecionado)
+    std::vector<char> m_buf;  // Buffer de saída
+    size_t m_used = 0;        // Bytes ocupados no buffer
+    std::string m_scratch;    // Conversão de icu::UnicodeString para UTF-8 (reutilizada entre palavras)
+
+    // Garante espaço para n bytes no buffer
+    void reserve(size_t n)
+    {
+        if (m_used + n > m_buf.size())
+            flush();
+    }
+
+public:
+    // Cria o buffer escrevendo no streambuf do stream (por padrão, cout)
+    explicit OutputBuffer(std::ostream &os = std::cout, size_t capacity = 1 << 20)
+        : m_dest(os.rdbuf()), m_buf(capacity) {}
+
+    // Desabilita a cópia do buffer
+    OutputBuffer(const OutputBuffer &o) = delete;
+    OutputBuffer &operator=(const OutputBuffer &o) = delete;
+
+    // Destrutor que envia o que sobrou no buffer
+    ~OutputBuffer()
+    {
+        flush();
+    }
+
+    // Envia o conteúdo do buffer para o destino
+    void flush()
+    {
+        if (m_used > 0)
+            m_dest->sputn(m_buf.data(), static_cast<std::streamsize>(m_used));
+        m_used = 0;
+    }
+
+    // Escreve bytes
+    void write(const char *data, size_t n)
+    {
+        if (n > m_buf.size())
+        {
+            flush();
+            m_dest->sputn(data, static_cast<std::streamsize>(n));
+            return;
+        }
+        reserve(n);
+        std::char_traits<char>::copy(m_buf.data() + m_used, data, n);
+        m_used += n;
+    }
+
+    OutputBuffer &operator<<(std::string_view s)
+    {
+        write(s.data(), s.size());
+        return *this;
+    }
+
+    OutputBuffer &operator<<(const char *s)
+    {
+        return *this << std::string_view(s);
+    }
+
+    OutputBuffer &operator<<(const std::string &s)
+    {
+        return *this << std::string_view(s);
+    }
+
+    OutputBuffer &operator<<(char c)
+    {
+        reserve(1);
+        m_buf[m_used++] = c;
+        return *this;
+    }
+
+    // Palavra internada: copiada direto da arena
+    OutputBuffer &operator<<(const WordRef &w)
+    {
+        write(w.data(), w.length());
+        return *this;
+    }
+
+    // Palavra icu::UnicodeString: convertida para UTF-8 em uma string reutilizada
+    OutputBuffer &operator<<(const icu::UnicodeString &s)
+    {
+        m_scratch.clear();
+        s.toUTF8String(m_scratch);
+        return *this << std::string_view(m_scratch);
+    }
+
+    // Números inteiros (com std::to_chars) e demais tipos (com operator<< de std::ostream)
+    // bool e os tipos de caractere são integrais, mas são escritos como o std::ostream os escreve
+    template <typename T>
+    OutputBuffer &operator<<(const T &value)
+    {
+        if constexpr (std::is_integral<T>::value && !std::is_same<T, bool>::value && !std::is_same<T, char>::value &&
+                      !std::is_same<T, signed char>::value && !std::is_same<T, unsigned char>::value &&
+                      !std::is_same<T, wchar_t>::value && !std::is_same<T, char16_t>::value && !std::is_same<T, char32_t>::value)
+        {
+            reserve(24);
+            auto result = std::to_chars(m_buf.data() + m_used, m_buf.data() + m_buf.size(), value);
+            m_used = result.ptr - m_buf.data();
+        }
+        else
+        {
+            std::ostringstream ss;
+            ss << value;
+            *this << ss.str();
+        }
+        return *this;
+    }
+
+    // Escreve uma linha "chave: valor" da lista de palavras
+    template <typename Key, typename Value>
+    void entry(const Key &key, const Value &value)
+    {
+        *this << key << ": " << value << '\n';
+    }
+};
+
+#endif
@@ -0,0 +1,201 @@
+#ifndef PERFCOUNTERS_H
+#define PERFCOUNTERS_H
+
+#include <iostream>
+#include <cstdint>
+#include <cstring>
+#include <cerrno>
+#include <string>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#endif
+
+// Eventos de hardware medidos
+enum class PerfEvent
+{
+    Cycles,       // Ciclos de CPU
+    Instructions, // Instruções executadas
+    CacheMisses,  // Faltas no último nível de cache
+    BranchMisses, // Desvios previstos errado
+    Count         // Número de eventos
+};
+
+// Valores dos contadores (um por evento); valid indica se o evento pôde ser medido
+struct PerfValues
+{
+    uint64_t value[static_cast<int>(PerfEvent::Count)] = {};
+    bool valid[static_cast<int>(PerfEvent::Count)] = {};
+
+    uint64_t operator[](PerfEvent e) const
+    {
+        return value[static_cast<int>(e)];
+    }
+
+    bool has(PerfEvent e) const
+    {
+        return valid[static_cast<int>(e)];
+    }
+
+    PerfValues &operator+=(const PerfValues &other)
+    {
+        for (int e = 0; e < static_cast<int>(PerfEvent::Count); e++)
+        {
+            value[e] += other.value[e];
+            valid[e] = valid[e] || other.valid[e];
+        }
+        return *this;
+    }
+
+    // Diferença entre duas leituras (fim - início)
+    PerfValues operator-(const PerfValues &start) const
+    {
+        PerfValues d;
+        for (int e = 0; e < static_cast<int>(PerfEvent::Count); e++)
+        {
+            d.valid[e] = valid[e] && start.valid[e];
+            d.value[e] = d.valid[e] && value[e] > start.value[e] ? value[e] - start.value[e] : 0;
+        }
+        return d;
+    }
+
+    // Nome do evento para o cabeçalho da saída
+    static const char *name(PerfEvent e)
+    {
+        static const char *names[] = {"Ciclos", "Instruções", "Cache misses", "Branch misses"};
+        return names[static_cast<int>(e)];
+    }
+
+    // Nome do evento no JSON
+    static const char *key(PerfEvent e)
+    {
+        static const char *keys[] = {"cycles", "instructions", "cache_misses", "branch_misses"};
+        return keys[static_cast<int>(e)];
+    }
+
+    // Grava em JSON apenas os eventos medidos ({"cycles": N, ...})
+    void write_json(std::ostream &os) const
+    {
+        os << "{";
+        bool first = true;
+        for (int e = 0; e < static_cast<int>(PerfEvent::Count); e++)
+        {
+            if (!valid[e])
+                continue;
+            os << (first ? "" : ", ") << '"' << key(static_cast<PerfEvent>(e)) << "\": " << value[e];
+            first = false;
+        }
+        os << "}";
+    }
+};
+
+// Contadores de hardware do processo via perf_event_open (Linux), sem ferramentas externas
+// Cada evento é aberto separadamente: se só alguns não existirem (máquinas virtuais), os outros
+// continuam medindo. Se nenhum puder ser aberto (contêineres, perf_event_paranoid, outro sistema),
+// available() é false, error() explica o motivo e read() devolve valores inválidos
+// Os contadores ficam ligados desde a construção; uma fase é medida pela diferença entre duas leituras.
+// As threads criadas depois da construção também são contadas (inherit)
+class PerfCounters
+{
+private:
+    int m_fd[static_cast<int>(PerfEvent::Count)];
+    std::string m_error;
+
+#ifdef __linux__
+    static int open_event(uint64_t config)
+    {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = config;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.inherit = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+#endif
+
+public:
+    PerfCounters()
+    {
+        for (int &fd : m_fd)
+            fd = -1;
+#ifdef __linux__
+        static const uint64_t configs[] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                           PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+        for (int e = 0; e < static_cast<int>(PerfEvent::Count); e++)
+        {
+            m_fd[e] = open_event(configs[e]);
+            if (m_fd[e] < 0 && m_error.empty())
+                m_error = std::string("perf_event_open: ") + std::strerror(errno);
+        }
+        if (available())
+            m_error.clear();
+        else if (m_error.find("ermission") != std::string::npos || m_error.find("not permitted") != std::string::npos)
+            m_error += " (veja /proc/sys/kernel/perf_event_paranoid)";
+#else
+        m_error = "contadores de hardware só são suportados no Linux";
+#endif
+    }
+
+    ~PerfCounters()
+    {
+#ifdef __linux__
+        for (int fd : m_fd)
+        {
+            if (fd >= 0)
+                close(fd);
+        }
+#endif
+    }
+
+    // Desabilita a cópia (os descritores pertencem a uma instância)
+    PerfCounters(const PerfCounters &p) = delete;
+    PerfCounters &operator=(const PerfCounters &p) = delete;
+
+    // Verifica se ao menos um evento está sendo medido
+    bool available() const
+    {
+        for (int fd : m_fd)
+        {
+            if (fd >= 0)
+                return true;
+        }
+        return false;
+    }
+
+    // Motivo da indisponibilidade (vazio se available())
+    const std::string &error() const
+    {
+        return m_error;
+    }
+
+    // Lê os valores acumulados desde a construção
+    // Quando o kernel reveza os contadores (mais eventos que registradores), o valor é extrapolado
+    // pela fração do tempo em que o evento esteve realmente sendo contado
+    PerfValues read() const
+    {
+        PerfValues v;
+#ifdef __linux__
+        for (int e = 0; e < static_cast<int>(PerfEvent::Count); e++)
+        {
+            if (m_fd[e] < 0)
+                continue;
+            uint64_t buf[3]; // valor, tempo habilitado, tempo contando
+            if (::read(m_fd[e], buf, sizeof(buf)) != static_cast<ssize_t>(sizeof(buf)))
+                continue;
+            if (buf[2] == 0)
+                continue;
+            v.value[e] = buf[2] < buf[1] ? static_cast<uint64_t>(static_cast<double>(buf[0]) * buf[1] / buf[2]) : buf[0];
+            v.valid[e] = true;
+        }
+#endif
+        return v;
+    }
+};
+
+#endif
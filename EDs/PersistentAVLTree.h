@@ -0,0 +1,478 @@
+#ifndef PERSISTENTAVLTREE_H
+#define PERSISTENTAVLTREE_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <unicode/unistr.h>
+#include <unicode/ustream.h>
+#include <unicode/ucnv.h>
+#include <unicode/coll.h>
+#include "extras.h"
+#include "OutputBuffer.h"
+#include "TopK.h"
+#include "EngineStats.h"
+#include "TrackingAllocator.h"
+
+// Estrutura de nó imutável da árvore AVL persistente
+// Um nó nunca é alterado depois de criado; cada escrita copia apenas o caminho da raiz
+// até o nó alterado e compartilha todo o resto com as versões anteriores
+template <typename T, typename Value>
+struct PNode
+{
+    const std::pair<T, Value> key;                 // Chave do nó de par Chave/Valor
+    const std::shared_ptr<const PNode> left;       // Ponteiro para o filho esquerdo
+    const std::shared_ptr<const PNode> right;      // Ponteiro para o filho direito
+    const int height;                              // Altura do nó
+
+    // Construtor do nó
+    PNode(const std::pair<T, Value> &k, std::shared_ptr<const PNode> l, std::shared_ptr<const PNode> r, int h)
+        : key(k), left(std::move(l)), right(std::move(r)), height(h) {}
+};
+
+// Implementação da árvore AVL persistente (cópia de caminho)
+// Um único escritor publica cada nova versão trocando atomicamente o ponteiro da versão atual;
+// snapshot() custa O(1) (apenas copia esse ponteiro) e a versão obtida continua legível, sem
+// travas, até ser liberada, enquanto o escritor segue inserindo sem esperar pelos leitores
+template <typename T, typename Value = int, typename COMPARATOR = comparator<T>, typename Stats = CountingStats>
+class PersistentAVLTree
+{
+private:
+    typedef std::shared_ptr<const PNode<T, Value>> NodePtr;
+
+    // Versão publicada da árvore: raiz e número de elementos consistentes entre si
+    struct Version
+    {
+        NodePtr root;
+        size_t size;
+    };
+
+    // Alocador dos nós e das versões; guarda o contador por shared_ptr porque um snapshot pode
+    // liberar nós depois que a árvore já foi destruída
+    typedef TrackingAllocator<PNode<T, Value>, std::shared_ptr<MemoryCounter>> Allocator;
+
+    std::shared_ptr<const Version> current; // Versão atual (lida e trocada com operações atômicas)
+    COMPARATOR compare;                     // Função de comparação personalizada
+    Stats stats;                            // Contadores de operações e comparações (somente do escritor)
+    std::shared_ptr<MemoryCounter> mem = std::make_shared<MemoryCounter>(); // Memória dos nós e versões vivos
+
+    // Função para obter a altura de um nó
+    static int height(const NodePtr &node)
+    {
+        return (node == nullptr) ? 0 : node->height;
+    }
+
+    // Cria um novo nó calculando a sua altura
+    NodePtr make(const std::pair<T, Value> &key, const NodePtr &left, const NodePtr &right)
+    {
+        int h = (height(left) > height(right) ? height(left) : height(right)) + 1;
+        return std::allocate_shared<const PNode<T, Value>>(Allocator(mem), key, left, right, h);
+    }
+
+    // Cria um novo nó já balanceado a partir de duas subárvores AVL válidas (rotações por cópia)
+    NodePtr balance(const std::pair<T, Value> &key, const NodePtr &left, const NodePtr &right)
+    {
+        int hl = height(left);
+        int hr = height(right);
+        if (hr > hl + 1)
+        {
+            if (height(right->left) > height(right->right))
+            {
+                // Rotação dupla direita-esquerda
+                stats.rotation(true);
+                const NodePtr &rl = right->left;
+                return make(rl->key, make(key, left, rl->left), make(right->key, rl->right, right->right));
+            }
+            // Rotação à esquerda
+            stats.rotation(false);
+            return make(right->key, make(key, left, right->left), right->right);
+        }
+        if (hl > hr + 1)
+        {
+            if (height(left->right) > height(left->left))
+            {
+                // Rotação dupla esquerda-direita
+                stats.rotation(true);
+                const NodePtr &lr = left->right;
+                return make(lr->key, make(left->key, left->left, lr->left), make(key, lr->right, right));
+            }
+            // Rotação à direita
+            stats.rotation(false);
+            return make(left->key, left->left, make(key, left->right, right));
+        }
+        return make(key, left, right);
+    }
+
+    // Função recursiva que devolve uma nova versão da subárvore com a chave inserida
+    // Com add = true soma value ao valor existente; caso contrário não altera chaves existentes
+    NodePtr _insert(const NodePtr &node, const T &key, Value value, bool add, bool &inserted)
+    {
+        if (node == nullptr)
+        {
+            inserted = true;
+            stats.insert();
+            return make({key, value}, nullptr, nullptr);
+        }
+        stats.visit();
+        stats.compare();
+        if (compare(key, node->key.first))
+        {
+            return balance(node->key, _insert(node->left, key, value, add, inserted), node->right);
+        }
+        else if (compare(node->key.first, key))
+        {
+            stats.compare();
+            return balance(node->key, node->left, _insert(node->right, key, value, add, inserted));
+        }
+        stats.compare();
+        if (!add)
+            return node;
+        return make({node->key.first, node->key.second + value}, node->left, node->right);
+    }
+
+    // Função recursiva que devolve uma nova versão da subárvore com o valor da chave substituído
+    NodePtr _update(const NodePtr &node, const T &key, Value value)
+    {
+        if (node == nullptr)
+            return node;
+        stats.compare();
+        if (compare(key, node->key.first))
+        {
+            return make(node->key, _update(node->left, key, value), node->right);
+        }
+        else if (compare(node->key.first, key))
+        {
+            stats.compare();
+            return make(node->key, node->left, _update(node->right, key, value));
+        }
+        stats.compare();
+        stats.update();
+        return make({node->key.first, value}, node->left, node->right);
+    }
+
+    // Função que devolve a subárvore sem o seu menor nó, guardando-o em min
+    NodePtr _delete_min(const NodePtr &node, NodePtr &min)
+    {
+        if (node->left == nullptr)
+        {
+            min = node;
+            return node->right;
+        }
+        return balance(node->key, _delete_min(node->left, min), node->right);
+    }
+
+    // Função recursiva que devolve uma nova versão da subárvore sem a chave
+    NodePtr _delete(const NodePtr &node, const T &key, bool &removed)
+    {
+        if (node == nullptr)
+            return node;
+        stats.visit();
+        stats.compare();
+        if (compare(key, node->key.first))
+        {
+            return balance(node->key, _delete(node->left, key, removed), node->right);
+        }
+        else if (compare(node->key.first, key))
+        {
+            stats.compare();
+            return balance(node->key, node->left, _delete(node->right, key, removed));
+        }
+        stats.compare();
+        removed = true;
+        stats.remove();
+        if (node->right == nullptr)
+            return node->left;
+        NodePtr successor;
+        NodePtr right = _delete_min(node->right, successor);
+        return balance(successor->key, node->left, right);
+    }
+
+    // Busca uma chave a partir de uma raiz qualquer (usada pela árvore e pelos snapshots)
+    // Os snapshots passam stats nulo (os contadores são somente do escritor)
+    static const PNode<T, Value> *_find(const NodePtr &root, const T &key, const COMPARATOR &compare, Stats *stats)
+    {
+        const PNode<T, Value> *node = root.get();
+        while (node != nullptr)
+        {
+            if (stats != nullptr)
+            {
+                stats->visit();
+                stats->compare();
+            }
+            if (compare(key, node->key.first))
+            {
+                node = node->left.get();
+            }
+            else if (compare(node->key.first, key))
+            {
+                if (stats != nullptr)
+                    stats->compare();
+                node = node->right.get();
+            }
+            else
+            {
+                if (stats != nullptr)
+                    stats->compare();
+                break;
+            }
+        }
+        if (stats != nullptr)
+            stats->end_search();
+        return node;
+    }
+
+    // Função que percorre uma versão da árvore em ordem (in-order), chamando fn(chave, valor)
+    template <typename F>
+    static void _for_each(const NodePtr &root, F &fn)
+    {
+        std::vector<const PNode<T, Value> *> stack;
+        const PNode<T, Value> *node = root.get();
+        while (node != nullptr || !stack.empty())
+        {
+            while (node != nullptr)
+            {
+                stack.push_back(node);
+                node = node->left.get();
+            }
+            node = stack.back();
+            stack.pop_back();
+            fn(node->key.first, node->key.second);
+            node = node->right.get();
+        }
+    }
+
+    // Seleciona as k chaves de maior valor de uma versão da árvore
+    static std::vector<std::pair<T, Value>> _top_k(const NodePtr &root, size_t k, const COMPARATOR &compare)
+    {
+        TopK<T, Value, COMPARATOR> top(k, compare);
+        std::vector<const PNode<T, Value> *> stack;
+        if (root != nullptr)
+            stack.push_back(root.get());
+        while (!stack.empty())
+        {
+            const PNode<T, Value> *node = stack.back();
+            stack.pop_back();
+            top.offer(node->key.first, node->key.second);
+            if (node->left != nullptr)
+                stack.push_back(node->left.get());
+            if (node->right != nullptr)
+                stack.push_back(node->right.get());
+        }
+        return top.result();
+    }
+
+    // Publica uma nova versão da árvore (visível para os próximos snapshots)
+    void publish(NodePtr root, size_t size)
+    {
+        std::shared_ptr<const Version> version = std::allocate_shared<const Version>(Allocator(mem), Version{std::move(root), size});
+        std::atomic_store(&current, std::move(version));
+    }
+
+    // Lê a versão atual da árvore
+    std::shared_ptr<const Version> load() const
+    {
+        return std::atomic_load(&current);
+    }
+
+public:
+    // Visão imutável de uma versão da árvore
+    // Continua válida (e consistente) enquanto o objeto existir, independente das escritas
+    // posteriores; os nós exclusivos desta versão são liberados quando ela é destruída
+    class Snapshot
+    {
+    private:
+        std::shared_ptr<const Version> version; // Versão observada
+        COMPARATOR compare;                     // Função de comparação personalizada
+
+    public:
+        Snapshot(std::shared_ptr<const Version> v, COMPARATOR comp) : version(std::move(v)), compare(comp) {}
+
+        // Busca o valor de uma chave nesta versão
+        Value find(const T &key) const
+        {
+            const PNode<T, Value> *node = _find(version->root, key, compare, nullptr);
+            return (node == nullptr) ? Value() : node->key.second;
+        }
+
+        // Verifica se a chave existe nesta versão
+        bool contains(const T &key) const
+        {
+            return _find(version->root, key, compare, nullptr) != nullptr;
+        }
+
+        // Número de elementos nesta versão
+        size_t size() const
+        {
+            return version->size;
+        }
+
+        // Imprime esta versão em ordem
+        void print() const
+        {
+            OutputBuffer out;
+            print(out);
+        }
+
+        // Imprime esta versão em ordem em um buffer de saída
+        void print(OutputBuffer &out) const
+        {
+            for_each([&out](const T &key, const Value &value)
+                     { out.entry(key, value); });
+        }
+
+        // Chama fn(chave, valor) para cada elemento desta versão, em ordem
+        template <typename F>
+        void for_each(F fn) const
+        {
+            _for_each(version->root, fn);
+        }
+
+        // Retorna as k chaves de maior valor desta versão, da maior para a menor
+        std::vector<std::pair<T, Value>> top_k(size_t k) const
+        {
+            return _top_k(version->root, k, compare);
+        }
+
+        // Libera a versão antes da destruição do snapshot
+        void release()
+        {
+            version.reset();
+        }
+    };
+
+    // Construtor da árvore AVL persistente
+    PersistentAVLTree(COMPARATOR comp = COMPARATOR()) : compare(comp)
+    {
+        publish(nullptr, 0);
+    }
+
+    // Desabilita a cópia da árvore (para compartilhar uma versão, use snapshot())
+    PersistentAVLTree(const PersistentAVLTree &t) = delete;
+    PersistentAVLTree &operator=(const PersistentAVLTree &t) = delete;
+
+    // Retorna uma visão imutável da versão atual em O(1)
+    Snapshot snapshot() const
+    {
+        return Snapshot(load(), compare);
+    }
+
+    // Função para inserir uma chave na árvore (não altera o valor se a chave já existir)
+    void insert(T key, Value value)
+    {
+        std::shared_ptr<const Version> v = load();
+        bool inserted = false;
+        NodePtr root = _insert(v->root, key, value, false, inserted);
+        stats.end_search();
+        if (inserted)
+            publish(std::move(root), v->size + 1);
+    }
+
+    // Soma value ao valor da chave, inserindo-a se necessário, em uma única cópia de caminho
+    void add(T key, Value value)
+    {
+        std::shared_ptr<const Version> v = load();
+        bool inserted = false;
+        NodePtr root = _insert(v->root, key, value, true, inserted);
+        stats.end_search();
+        publish(std::move(root), v->size + (inserted ? 1 : 0));
+    }
+
+    // Função para remover uma chave da árvore
+    void remove(T key)
+    {
+        std::shared_ptr<const Version> v = load();
+        bool removed = false;
+        NodePtr root = _delete(v->root, key, removed);
+        stats.end_search();
+        if (removed)
+            publish(std::move(root), v->size - 1);
+    }
+
+    // Função para atualizar o valor de uma chave
+    void update(T key, Value value)
+    {
+        std::shared_ptr<const Version> v = load();
+        if (_find(v->root, key, compare, &stats) != nullptr)
+            publish(_update(v->root, key, value), v->size);
+    }
+
+    // Função para buscar uma chave na versão atual
+    Value find(T key)
+    {
+        stats.lookup();
+        const PNode<T, Value> *node = _find(load()->root, key, compare, &stats);
+        return (node == nullptr) ? Value() : node->key.second;
+    }
+
+    // Função para imprimir a versão atual da árvore
+    void print() const
+    {
+        snapshot().print();
+    }
+
+    // Função para imprimir a versão atual da árvore em um buffer de saída
+    void print(OutputBuffer &out) const
+    {
+        snapshot().print(out);
+    }
+
+    // Chama fn(chave, valor) para cada elemento da versão atual, em ordem
+    template <typename F>
+    void for_each(F fn) const
+    {
+        snapshot().for_each(fn);
+    }
+
+    // Função que retorna as k chaves de maior valor da versão atual, da maior para a menor
+    std::vector<std::pair<T, Value>> top_k(size_t k) const
+    {
+        return snapshot().top_k(k);
+    }
+
+    // Função para limpar a árvore (snapshots anteriores continuam válidos)
+    void clear()
+    {
+        publish(nullptr, 0);
+    }
+
+    // Função que verifica se a versão atual contém uma chave
+    bool contains(const T &key)
+    {
+        stats.lookup();
+        return _find(load()->root, key, compare, &stats) != nullptr;
+    }
+
+    // Função para retornar o número de comparações feitas
+    size_t comparisons()
+    {
+        return stats.comparisons();
+    }
+
+    // Função que retorna as estatísticas da versão atual (contadores do escritor e altura)
+    EngineStats statistics() const
+    {
+        std::shared_ptr<const Version> v = load();
+        EngineStats s = stats.counters();
+        s.layout = EngineLayout::Tree;
+        s.height = height(v->root);
+        s.size = v->size;
+        return s;
+    }
+
+    // Função que retorna a memória dos nós e versões ainda vivos (estrutura, chaves e valores)
+    // Inclui os nós que só snapshots anteriores ainda referenciam
+    MemoryUsage memory() const
+    {
+        return mem->usage(size(), sizeof(T), sizeof(Value));
+    }
+
+    // Função para retornar o número de elementos na versão atual
+    size_t size() const
+    {
+        return load()->size;
+    }
+};
+
+#endif
@@ -0,0 +1,158 @@
+#ifndef PHASETIMER_H
+#define PHASETIMER_H
+
+#include <iostream>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include "PerfCounters.h"
+
+// Fases de uma execução, na ordem em que acontecem
+enum class Phase
+{
+    Read,      // Leitura do arquivo
+    Decode,    // Conversão UTF-8 -> UnicodeString e de volta para UTF-8
+    Normalize, // Minúsculas e remoção dos caracteres que não são letras
+    Tokenize,  // Divisão do texto em palavras
+    Estimate,  // Passada do HyperLogLog que estima o vocabulário (--hll)
+    Insert,    // Inserção das palavras na estrutura
+    Output,    // Ordenação e impressão da lista de palavras
+    Count      // Número de fases
+};
+
+// Tempo acumulado de cada fase, em nanossegundos
+// Com contadores de hardware ligados (attach), também acumula os contadores de cada fase
+class PhaseTimings
+{
+private:
+    uint64_t m_ns[static_cast<int>(Phase::Count)] = {};
+    const PerfCounters *m_perf = nullptr;                // Contadores de hardware (nulo se desligados)
+    PerfValues m_counters[static_cast<int>(Phase::Count)]; // Contadores acumulados de cada fase
+    uint64_t m_tokens = 0;                               // Palavras processadas na fase de inserção
+
+public:
+    void add(Phase phase, uint64_t ns)
+    {
+        m_ns[static_cast<int>(phase)] += ns;
+    }
+
+    // Liga a medição dos contadores de hardware em cada fase
+    void attach(const PerfCounters *perf)
+    {
+        m_perf = perf;
+    }
+
+    const PerfCounters *perf() const
+    {
+        return m_perf;
+    }
+
+    void add(Phase phase, const PerfValues &counters)
+    {
+        m_counters[static_cast<int>(phase)] += counters;
+    }
+
+    const PerfValues &counters(Phase phase) const
+    {
+        return m_counters[static_cast<int>(phase)];
+    }
+
+    // Número de palavras da fase de inserção (para os valores por palavra)
+    void add_tokens(uint64_t n)
+    {
+        m_tokens += n;
+    }
+
+    uint64_t tokens() const
+    {
+        return m_tokens;
+    }
+
+    uint64_t ns(Phase phase) const
+    {
+        return m_ns[static_cast<int>(phase)];
+    }
+
+    // Soma de todas as fases
+    uint64_t total() const
+    {
+        uint64_t sum = 0;
+        for (uint64_t ns : m_ns)
+            sum += ns;
+        return sum;
+    }
+
+    // Nome da fase para o cabeçalho da saída
+    static const char *name(Phase phase)
+    {
+        static const char *names[] = {"Leitura", "Decodificação", "Normalização", "Tokenização", "Estimativa do vocabulário", "Inserção", "Ordenação/impressão"};
+        return names[static_cast<int>(phase)];
+    }
+
+    // Nome da fase no JSON
+    static const char *key(Phase phase)
+    {
+        static const char *keys[] = {"read", "decode", "normalize", "tokenize", "estimate", "insert", "output"};
+        return keys[static_cast<int>(phase)];
+    }
+
+    // Grava os tempos em JSON ({"phases_ns": {...}, "total_ns": N})
+    // Com contadores de hardware, inclui também "counters" (por fase) e "tokens"; se eles estiverem
+    // indisponíveis, "counters_error" traz o motivo
+    void write_json(std::ostream &os) const
+    {
+        os << "{\n  \"phases_ns\": {";
+        for (int p = 0; p < static_cast<int>(Phase::Count); p++)
+            os << (p ? "," : "") << "\n    \"" << key(static_cast<Phase>(p)) << "\": " << m_ns[p];
+        os << "\n  },\n  \"total_ns\": " << total();
+        if (m_perf != nullptr && m_perf->available())
+        {
+            os << ",\n  \"tokens\": " << m_tokens << ",\n  \"counters\": {";
+            for (int p = 0; p < static_cast<int>(Phase::Count); p++)
+            {
+                os << (p ? "," : "") << "\n    \"" << key(static_cast<Phase>(p)) << "\": ";
+                m_counters[p].write_json(os);
+            }
+            os << "\n  }";
+        }
+        else if (m_perf != nullptr)
+            os << ",\n  \"counters_error\": \"" << m_perf->error() << "\"";
+        os << "\n}\n";
+    }
+};
+
+// Mede o tempo de vida do escopo e soma na fase (e os contadores de hardware, se ligados)
+// Com timings nulo (medição desligada) o relógio não é lido: o custo é só o teste do ponteiro
+class ScopedTimer
+{
+private:
+    PhaseTimings *m_timings;
+    Phase m_phase;
+    std::chrono::steady_clock::time_point m_start;
+    PerfValues m_counters; // Leitura dos contadores no início do escopo
+
+public:
+    ScopedTimer(PhaseTimings *timings, Phase phase) : m_timings(timings), m_phase(phase)
+    {
+        if (m_timings == nullptr)
+            return;
+        if (m_timings->perf() != nullptr)
+            m_counters = m_timings->perf()->read();
+        m_start = std::chrono::steady_clock::now();
+    }
+
+    ~ScopedTimer()
+    {
+        if (m_timings == nullptr)
+            return;
+        m_timings->add(m_phase, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_start).count());
+        if (m_timings->perf() != nullptr)
+            m_timings->add(m_phase, m_timings->perf()->read() - m_counters);
+    }
+
+    // Desabilita a cópia do medidor
+    ScopedTimer(const ScopedTimer &t) = delete;
+    ScopedTimer &operator=(const ScopedTimer &t) = delete;
+};
+
+#endif
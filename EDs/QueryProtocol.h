@@ -0,0 +1,184 @@
+#ifndef QUERYPROTOCOL_H
+#define QUERYPROTOCOL_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Protocolo binário das consultas ao servidor de dicionário (server.cpp) por socket Unix
+//
+// Cada mensagem é um quadro [tamanho: uint32][corpo: tamanho bytes], com inteiros em little-endian
+//   pedido:   [op: uint8][arg: uint32][palavra: bytes UTF-8 até o fim do corpo]
+//   resposta: [status: uint8][n: uint32][n entradas [frequência: uint32][tamanho: uint32][palavra]]
+// find responde n = frequência (0 se ausente) e contains n = 0 ou 1, ambos sem entradas; top_k
+// (arg = k) e prefix (arg = limite, 0 = sem limite) respondem n entradas. As respostas saem na ordem
+// dos pedidos, então o cliente pode mandar vários pedidos seguidos sem esperar (pipelining)
+enum class QueryOp : uint8_t
+{
+    Find = 1,     // Frequência da palavra
+    Contains = 2, // Se a palavra está no dicionário
+    TopK = 3,     // As arg palavras mais frequentes
+    Prefix = 4    // Palavras que começam com a palavra dada, na ordem alfabética (até arg palavras)
+};
+
+// Situação da resposta
+enum class QueryStatus : uint8_t
+{
+    Ok = 0,
+    BadRequest = 1 // Operação desconhecida ou pedido curto demais
+};
+
+// Tamanho máximo do corpo de um quadro (pedidos maiores fecham a conexão)
+static const uint32_t QUERY_MAX_FRAME = 1 << 24;
+
+// Acrescenta um uint32 em little-endian
+inline void put_u32(std::string &buf, uint32_t v)
+{
+    char b[4] = {static_cast<char>(v), static_cast<char>(v >> 8), static_cast<char>(v >> 16), static_cast<char>(v >> 24)};
+    buf.append(b, 4);
+}
+
+// Lê um uint32 em little-endian
+inline uint32_t get_u32(const char *p)
+{
+    const unsigned char *b = reinterpret_cast<const unsigned char *>(p);
+    return uint32_t(b[0]) | uint32_t(b[1]) << 8 | uint32_t(b[2]) << 16 | uint32_t(b[3]) << 24;
+}
+
+// Acrescenta um pedido ao buffer de saída
+inline void encode_request(std::string &buf, QueryOp op, uint32_t arg, std::string_view word)
+{
+    put_u32(buf, static_cast<uint32_t>(1 + 4 + word.size()));
+    buf.push_back(static_cast<char>(op));
+    put_u32(buf, arg);
+    buf.append(word.data(), word.size());
+}
+
+// Pedido lido de um quadro (a palavra aponta para o buffer de entrada)
+struct QueryRequest
+{
+    QueryOp op;
+    uint32_t arg;
+    std::string_view word;
+};
+
+// Interpreta o corpo de um quadro de pedido; retorna false se ele for curto demais
+inline bool decode_request(std::string_view body, QueryRequest &req)
+{
+    if (body.size() < 5)
+        return false;
+    req.op = static_cast<QueryOp>(body[0]);
+    req.arg = get_u32(body.data() + 1);
+    req.word = body.substr(5);
+    return true;
+}
+
+// Acrescenta uma resposta sem entradas (find, contains, erros)
+inline void encode_response(std::string &buf, QueryStatus status, uint32_t n)
+{
+    put_u32(buf, 1 + 4);
+    buf.push_back(static_cast<char>(status));
+    put_u32(buf, n);
+}
+
+// Acrescenta uma resposta com entradas (top_k, prefix)
+template <typename Entries>
+void encode_response(std::string &buf, const Entries &entries)
+{
+    size_t start = buf.size();
+    put_u32(buf, 0); // Tamanho, preenchido no final
+    buf.push_back(static_cast<char>(QueryStatus::Ok));
+    put_u32(buf, static_cast<uint32_t>(entries.size()));
+    for (const auto &e : entries)
+    {
+        put_u32(buf, static_cast<uint32_t>(e.second));
+        put_u32(buf, static_cast<uint32_t>(e.first.size()));
+        buf.append(e.first.data(), e.first.size());
+    }
+    uint32_t body = static_cast<uint32_t>(buf.size() - start - 4);
+    for (int i = 0; i < 4; i++)
+        buf[start + i] = static_cast<char>(body >> (8 * i));
+}
+
+// Resposta lida de um quadro
+struct QueryResponse
+{
+    QueryStatus status;
+    uint32_t n;
+    std::vector<std::pair<std::string, uint32_t>> entries; // Palavras e frequências (top_k, prefix)
+};
+
+// Interpreta o corpo de um quadro de resposta; retorna false se ele estiver mal formado
+// Com entries = false as entradas são puladas (o gerador de carga só confere o tamanho)
+inline bool decode_response(std::string_view body, QueryResponse &res, bool entries = true)
+{
+    if (body.size() < 5)
+        return false;
+    res.status = static_cast<QueryStatus>(body[0]);
+    res.n = get_u32(body.data() + 1);
+    res.entries.clear();
+    if (!entries)
+        return true;
+    size_t pos = 5;
+    while (pos < body.size())
+    {
+        if (body.size() - pos < 8)
+            return false;
+        uint32_t count = get_u32(body.data() + pos);
+        uint32_t len = get_u32(body.data() + pos + 4);
+        pos += 8;
+        if (body.size() - pos < len)
+            return false;
+        res.entries.emplace_back(std::string(body.substr(pos, len)), count);
+        pos += len;
+    }
+    return true;
+}
+
+// Separa quadros completos de um buffer de entrada que recebe bytes aos pedaços
+// next devolve o corpo do próximo quadro completo (válido até a próxima chamada de feed ou compact)
+class FrameReader
+{
+private:
+    std::string m_buf;
+    size_t m_pos = 0; // Início do próximo quadro ainda não lido
+
+public:
+    // Acrescenta bytes recebidos
+    void feed(const char *data, size_t n)
+    {
+        m_buf.append(data, n);
+    }
+
+    // Retorna 1 e o corpo se há um quadro completo, 0 se falta receber bytes e -1 se o quadro é grande demais
+    int next(std::string_view &body)
+    {
+        if (m_buf.size() - m_pos < 4)
+            return 0;
+        uint32_t len = get_u32(m_buf.data() + m_pos);
+        if (len > QUERY_MAX_FRAME)
+            return -1;
+        if (m_buf.size() - m_pos - 4 < len)
+            return 0;
+        body = std::string_view(m_buf.data() + m_pos + 4, len);
+        m_pos += 4 + len;
+        return 1;
+    }
+
+    // Descarta os quadros já lidos (invalida os corpos devolvidos por next)
+    void compact()
+    {
+        m_buf.erase(0, m_pos);
+        m_pos = 0;
+    }
+
+    // Bytes recebidos e ainda não consumidos
+    size_t pending() const
+    {
+        return m_buf.size() - m_pos;
+    }
+};
+
+#endif
@@ -8,6 +8,10 @@
 #include <unicode/ucnv.h>
 #include <unicode/coll.h>
 #include "extras.h"
+#include "OutputBuffer.h"
+#include "TopK.h"
+#include "EngineStats.h"
+#include "TrackingAllocator.h"
 
 // Definição das cores dos nós em uma árvore rubro negra
 enum Color
@@ -31,13 +35,14 @@ struct RBNode
 };
 
 // Classe da árvore rubro negra
-template <typename T, typename Value = int, typename COMPARATOR = comparator<T>>
+template <typename T, typename Value = int, typename COMPARATOR = comparator<T>, typename Stats = CountingStats>
 class RBTree
 {
 private:
     RBNode<T, Value> *root = nullptr; // Raiz da árvore
     COMPARATOR compare;               // Função de comparação
-    unsigned int comps = 0;           // Contador de comparações
+    Stats stats;                      // Contadores de operações e comparações
+    MemoryCounter mem;                // Memória alocada pelos nós
     unsigned int _size = 0;           // Tamanho da árvore (número de nós)
 
     // Rotação à esquerda para manutenção da propriedade da árvore rubro negra
@@ -109,6 +114,7 @@ private:
                 }
                 else
                 {
+                    stats.rotation(z == z->parent->right);
                     if (z == z->parent->right)
                     {
                         z = z->parent;
@@ -131,6 +137,7 @@ private:
                 }
                 else
                 {
+                    stats.rotation(z == z->parent->left);
                     if (z == z->parent->left)
                     {
                         z = z->parent;
@@ -146,103 +153,113 @@ private:
     }
 
     // Ajuste da árvore após a remoção para manter as propriedades rubro negra
-    void fixupDelete(RBNode<T, Value> *x)
+    // x pode ser nulo (folha preta removida), por isso o pai de x é passado à parte
+    void fixupDelete(RBNode<T, Value> *x, RBNode<T, Value> *parent)
     {
-        while (x != root && x->color == BLACK)
+        while (x != root && (x == nullptr || x->color == BLACK))
         {
-            if (x == x->parent->left)
+            if (x == parent->left)
             {
-                RBNode<T, Value> *w = x->parent->right;
+                RBNode<T, Value> *w = parent->right;
                 if (w->color == RED)
                 {
+                    stats.rotation(false);
                     w->color = BLACK;
-                    x->parent->color = RED;
-                    leftRotate(x->parent);
-                    w = x->parent->right;
+                    parent->color = RED;
+                    leftRotate(parent);
+                    w = parent->right;
                 }
                 if ((w->left == nullptr || w->left->color == BLACK) &&
                     (w->right == nullptr || w->right->color == BLACK))
                 {
                     w->color = RED;
-                    x = x->parent;
+                    x = parent;
+                    parent = x->parent;
                 }
                 else
                 {
+                    stats.rotation(w->right == nullptr || w->right->color == BLACK);
                     if (w->right == nullptr || w->right->color == BLACK)
                     {
-                        if (w->left != nullptr)
-                            w->left->color = BLACK;
+                        w->left->color = BLACK;
                         w->color = RED;
                         rightRotate(w);
-                        w = x->parent->right;
+                        w = parent->right;
                     }
-                    w->color = x->parent->color;
-                    x->parent->color = BLACK;
+                    w->color = parent->color;
+                    parent->color = BLACK;
                     if (w->right != nullptr)
                         w->right->color = BLACK;
-                    leftRotate(x->parent);
+                    leftRotate(parent);
                     x = root;
                 }
             }
             else
             {
-                RBNode<T, Value> *w = x->parent->left;
+                RBNode<T, Value> *w = parent->left;
                 if (w->color == RED)
                 {
+                    stats.rotation(false);
                     w->color = BLACK;
-                    x->parent->color = RED;
-                    rightRotate(x->parent);
-                    w = x->parent->left;
+                    parent->color = RED;
+                    rightRotate(parent);
+                    w = parent->left;
                 }
                 if ((w->left == nullptr || w->left->color == BLACK) &&
                     (w->right == nullptr || w->right->color == BLACK))
                 {
                     w->color = RED;
-                    x = x->parent;
+                    x = parent;
+                    parent = x->parent;
                 }
                 else
                 {
+                    stats.rotation(w->left == nullptr || w->left->color == BLACK);
                     if (w->left == nullptr || w->left->color == BLACK)
                     {
-                        if (w->right != nullptr)
-                            w->right->color = BLACK;
+                        w->right->color = BLACK;
                         w->color = RED;
                         leftRotate(w);
-                        w = x->parent->left;
+                        w = parent->left;
                     }
-                    w->color = x->parent->color;
-                    x->parent->color = BLACK;
+                    w->color = parent->color;
+                    parent->color = BLACK;
                     if (w->left != nullptr)
                         w->left->color = BLACK;
-                    rightRotate(x->parent);
+                    rightRotate(parent);
                     x = root;
                 }
             }
         }
-        x->color = BLACK;
+        if (x != nullptr)
+            x->color = BLACK;
     }
 
     // Função auxiliar para remoção de um nó com uma determinada chave
     RBNode<T, Value> *_delete(RBNode<T, Value> *node, T key)
     {
-        RBNode<T, Value> *z = root;
+        RBNode<T, Value> *z = node;
         RBNode<T, Value> *y = nullptr;
         RBNode<T, Value> *x = nullptr;
 
         // Encontra o nó a ser removido
         while (z != nullptr)
         {
-            if (key == z->key.first)
+            stats.visit();
+            stats.compare();
+            if (compare(key, z->key.first))
             {
-                break;
+                z = z->left;
             }
-            else if (compare(key, z->key.first))
+            else if (compare(z->key.first, key))
             {
-                z = z->left;
+                stats.compare();
+                z = z->right;
             }
             else
             {
-                z = z->right;
+                stats.compare();
+                break;
             }
         }
 
@@ -269,15 +286,16 @@ private:
             x = y->right;
 
         // Reconecta o pai de y ao filho de y
+        RBNode<T, Value> *parent = y->parent;
         if (x != nullptr)
-            x->parent = y->parent;
+            x->parent = parent;
 
-        if (y->parent == nullptr)
+        if (parent == nullptr)
             root = x;
-        else if (y == y->parent->left)
-            y->parent->left = x;
+        else if (y == parent->left)
+            parent->left = x;
         else
-            y->parent->right = x;
+            parent->right = x;
 
         // Se y não é o nó a ser removido, mova os dados de y para z
         if (y != z)
@@ -286,63 +304,80 @@ private:
             z->key.second = y->key.second;
         }
 
-        // Se y era preto, a árvore pode precisar de ajustes
-        if (y->color == BLACK && x != nullptr)
-            fixupDelete(x);
+        // Se y era preto, a árvore pode precisar de ajustes (mesmo quando x é nulo)
+        if (y->color == BLACK && root != nullptr)
+            fixupDelete(x, parent);
 
         // Libera a memória de y e atualiza o tamanho da árvore
-        delete y;
+        tracked_delete(mem, y);
         _size--;
+        stats.remove();
         return root;
     }
 
-    // Função auxiliar para inserção de um novo nó
-    RBNode<T, Value> *_insert(RBNode<T, Value> *node, T key, Value value)
+    // Função auxiliar para inserção de um novo nó; retorna o nó inserido (nulo se a chave já existia)
+    RBNode<T, Value> *_insert(T key, Value value)
     {
-        if (node == nullptr)
-        {
-            _size++;
-            return new RBNode<T, Value>(key, value);
-        }
-        comps++;
-        if (compare(key, node->key.first))
-        {
-            node->left = _insert(node->left, key, value);
-            node->left->parent = node;
-        }
-        else if (compare(node->key.first, key))
-        {
-            comps++;
-            node->right = _insert(node->right, key, value);
-            node->right->parent = node;
-        }
-        else
+        RBNode<T, Value> *parent = nullptr;
+        RBNode<T, Value> *node = root;
+        bool left = false;
+        while (node != nullptr)
         {
-            comps++;
-            return node;
+            parent = node;
+            stats.visit();
+            stats.compare();
+            if (compare(key, node->key.first))
+            {
+                node = node->left;
+                left = true;
+            }
+            else if (compare(node->key.first, key))
+            {
+                stats.compare();
+                node = node->right;
+                left = false;
+            }
+            else
+            {
+                stats.compare();
+                return nullptr;
+            }
         }
 
+        node = tracked_new<RBNode<T, Value>>(mem, key, value);
+        node->parent = parent;
+        if (parent == nullptr)
+            root = node;
+        else if (left)
+            parent->left = node;
+        else
+            parent->right = node;
+        _size++;
+        stats.insert();
         return node;
     }
 
-    // Função auxiliar para imprimir a árvore em ordem
-    void _print(RBNode<T, Value> *node) const
+    // Função auxiliar que percorre a árvore em ordem, chamando fn(chave, valor)
+    template <typename F>
+    void _for_each(RBNode<T, Value> *node, F &fn) const
     {
         if (node == nullptr)
             return;
 
-        _print(node->left);
-        if constexpr (std::is_same<T, icu::UnicodeString>::value)
-        {
-            std::string skey;
-            node->key.first.toUTF8String(skey);
-            std::cout << skey << ": " << node->key.second << std::endl;
-        }
-        else
-        {
-            std::cout << node->key.first << ": " << node->key.second << std::endl;
-        }
-        _print(node->right);
+        _for_each(node->left, fn);
+        fn(node->key.first, node->key.second);
+        _for_each(node->right, fn);
+    }
+
+    // Função auxiliar que oferece todos os nós da subárvore à seleção das mais frequentes
+    void _top_k(RBNode<T, Value> *node, TopK<T, Value, COMPARATOR> &top) const
+    {
+        if (node == nullptr)
+            return;
+
+        _top_k(node->left, top);
+        top.offer(node->key.first, node->key.second);
+        _top_k(node->right, top);
     }
 
     // Função auxiliar para limpar a árvore
@@ -356,31 +391,34 @@ private:
         _clear(node->right);
 
         // Depois de limpar as subárvores, delete o nó atual
-        delete node;
+        tracked_delete(mem, node);
     }
 
-    // Função auxiliar para verificar se a árvore contém uma chave
-    bool _contains(RBNode<T, Value> *node, T key)
+    // Função auxiliar que busca o nó de uma chave (nullptr se ela não estiver na árvore)
+    RBNode<T, Value> *_find(const T &key)
     {
+        RBNode<T, Value> *node = root;
         while (node != nullptr)
         {
-            comps++;
+            stats.visit();
+            stats.compare();
             if (compare(key, node->key.first))
             {
                 node = node->left;
             }
             else if (compare(node->key.first, key))
             {
-                comps++;
+                stats.compare();
                 node = node->right;
             }
             else
             {
-                comps++;
-                return true;
+                stats.compare();
+                break;
             }
         }
-        return false;
+        stats.end_search();
+        return node;
     }
 
 public:
@@ -391,101 +429,88 @@ public:
         _size = 0;
     }
 
+    // Destrutor da árvore (libera todos os nós)
+    ~RBTree()
+    {
+        clear();
+    }
+
+    // Desabilita a cópia da árvore
+    RBTree(const RBTree &t) = delete;
+    RBTree &operator=(const RBTree &t) = delete;
+
     // Função para inserir um nó na árvore
     void insert(T key, Value value)
     {
-        RBNode<T, Value> *newNode = _insert(root, key, value);
-        root = newNode;
-        fixupInsert(newNode);
+        RBNode<T, Value> *newNode = _insert(key, value);
+        stats.end_search();
+        if (newNode != nullptr)
+            fixupInsert(newNode);
     }
 
     // Função para remover um nó da árvore
     void remove(T key)
     {
         root = _delete(root, key);
+        stats.end_search();
     }
 
     // Função para atualizar o valor associado a uma chave na árvore
     void update(T key, Value value)
     {
-        RBNode<T, Value> *node = root;
-        while (node != nullptr)
+        RBNode<T, Value> *node = _find(key);
+        if (node != nullptr)
         {
-            comps++;
-            if (compare(key, node->key.first))
-            {
-                node = node->left;
-            }
-            else if (compare(node->key.first, key))
-            {
-                comps++;
-                node = node->right;
-            }
-            else
-            {
-                comps++;
-                node->key.second = value;
-                return;
-            }
+            stats.update();
+            node->key.second = value;
         }
     }
 
     // Função para encontrar uma chave na árvore
     Value find(T key)
     {
-        RBNode<T, Value> *node = root;
-        while (node != nullptr)
-        {
-            comps++;
-            if (compare(key, node->key.first))
-            {
-                node = node->left;
-            }
-            else if (compare(node->key.first, key))
-            {
-                comps++;
-                node = node->right;
-            }
-            else
-            {
-                comps++;
-                return node->key.second;
-            }
-        }
-        return Value();
+        stats.lookup();
+        RBNode<T, Value> *node = _find(key);
+        return (node == nullptr) ? Value() : node->key.second;
     }
 
-
-
     // Operador de índice const para acessar elementos na tabela
     Value &operator[](const T &key)
     {
-        RBNode<T, Value> *node = root;
-        while (node != nullptr)
-        {
-            comps++;
-            if (compare(key, node->key.first))
-            {
-                node = node->left;
-            }
-            else if (compare(node->key.first, key))
-            {
-                comps++;
-                node = node->right;
-            }
-            else
-            {
-                comps++;
-                return node->key.second;
-            }
-        }
-        throw std::out_of_range("Key not found"); // Lança exceção se a chave não for encontrada
+        stats.lookup();
+        RBNode<T, Value> *node = _find(key);
+        if (node == nullptr)
+            throw std::out_of_range("Key not found"); // Lança exceção se a chave não for encontrada
+        return node->key.second;
     }
 
     // Função para imprimir a árvore em ordem
     void print() const
     {
-        _print(root);
+        OutputBuffer out;
+        print(out);
+    }
+
+    // Função para imprimir a árvore em ordem em um buffer de saída
+    void print(OutputBuffer &out) const
+    {
+        for_each([&out](const T &key, const Value &value)
+                 { out.entry(key, value); });
+    }
+
+    // Chama fn(chave, valor) para cada elemento, em ordem (a mesma da lista impressa)
+    template <typename F>
+    void for_each(F fn) const
+    {
+        _for_each(root, fn);
+    }
+
+    // Função que retorna as k chaves de maior valor, da maior para a menor
+    std::vector<std::pair<T, Value>> top_k(size_t k) const
+    {
+        TopK<T, Value, COMPARATOR> top(k, compare);
+        _top_k(root, top);
+        return top.result();
     }
 
     // Função para limpar a árvore
@@ -501,13 +526,30 @@ public:
     // Função para verificar se a árvore contém uma chave
     bool contains(T key)
     {
-        return _contains(root, key);
+        stats.lookup();
+        return _find(key) != nullptr;
     }
 
     // Retorna o número de comparações realizadas
     size_t comparisons()
     {
-        return comps;
+        return stats.comparisons();
+    }
+
+    // Retorna as estatísticas da árvore (contadores e altura atual)
+    EngineStats statistics() const
+    {
+        EngineStats s = stats.counters();
+        s.layout = EngineLayout::Tree;
+        s.height = tree_height(root);
+        s.size = _size;
+        return s;
+    }
+
+    // Retorna a memória ocupada pelos nós (estrutura, chaves e valores)
+    MemoryUsage memory() const
+    {
+        return mem.usage(_size, sizeof(T), sizeof(Value));
     }
 
     // Retorna o tamanho da árvore (número de nós)
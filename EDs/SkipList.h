@@ -0,0 +1,377 @@
+#ifndef SKIPLIST_H
+#define SKIPLIST_H
+
+#include <iostream>
+#include <string>
+#include <atomic>
+#include <random>
+#include <unicode/unistr.h>
+#include <unicode/ustream.h>
+#include <unicode/ucnv.h>
+#include <unicode/coll.h>
+#include "extras.h"
+#include "OutputBuffer.h"
+#include "TopK.h"
+#include "EngineStats.h"
+#include "TrackingAllocator.h"
+
+// Número máximo de níveis da skip list (suficiente para ~4^16 chaves com p = 1/4)
+const int SKIPLIST_MAX_LEVEL = 16;
+
+// Estrutura de nó da skip list
+// Os nós nunca são liberados enquanto a lista existe (remoção lógica), então os
+// leitores podem percorrer a lista sem travas mesmo com escritores ativos
+template <typename T, typename Value>
+struct SkipNode
+{
+    T key;                            // Chave do nó
+    std::atomic<Value> value;         // Valor associado (atualizado atomicamente)
+    std::atomic<bool> removed;        // Marca de remoção lógica
+    int level;                        // Número de níveis do nó
+    std::atomic<SkipNode<T, Value> *> *next; // Ponteiros para o próximo nó em cada nível
+
+    // Construtor do nó; links é o vetor de lvl ponteiros, alocado (e liberado) pela lista
+    SkipNode(const T &k, Value v, int lvl, std::atomic<SkipNode<T, Value> *> *links)
+        : key(k), value(v), removed(false), level(lvl), next(links)
+    {
+        for (int i = 0; i < lvl; i++)
+            ::new (static_cast<void *>(&next[i])) std::atomic<SkipNode<T, Value> *>(nullptr);
+    }
+};
+
+// Implementação de uma skip list ordenada e livre de travas (lock-free)
+// Várias threads podem chamar add/insert/find/contains/operator[] ao mesmo tempo, e print pode
+// percorrer a lista em ordem enquanto as inserções continuam. A inserção liga o nó no nível 0
+// com compare-and-swap (ponto de linearização) e depois nos níveis superiores.
+// remove, update e clear devem ser chamados sem outras threads escrevendo na mesma chave
+// (remove e update) ou na lista (clear)
+template <typename T, typename Value = int, typename COMPARATOR = comparator<T>, typename Stats = CountingStats>
+class SkipList
+{
+private:
+    SkipNode<T, Value> *head;                // Nó sentinela (não guarda chave)
+    COMPARATOR compare;                      // Função de comparação personalizada
+    SharedStats<Stats> stats;                // Contadores de operações e comparações (atômicos)
+    MemoryCounter mem;                       // Memória alocada pelos nós e seus vetores de níveis
+    std::atomic<size_t> _size{0};            // Número de elementos na lista
+
+    // Cria um nó com lvl níveis (o nó e o vetor de ponteiros são contados em mem)
+    SkipNode<T, Value> *make_node(const T &key, Value value, int lvl)
+    {
+        TrackingAllocator<std::atomic<SkipNode<T, Value> *>> alloc(&mem);
+        std::atomic<SkipNode<T, Value> *> *links = alloc.allocate(lvl);
+        return tracked_new<SkipNode<T, Value>>(mem, key, value, lvl, links);
+    }
+
+    // Libera um nó criado por make_node
+    void free_node(SkipNode<T, Value> *node)
+    {
+        if (node == nullptr)
+            return;
+        TrackingAllocator<std::atomic<SkipNode<T, Value> *>>(&mem).deallocate(node->next, node->level);
+        tracked_delete(mem, node);
+    }
+
+    // Sorteia o número de níveis de um novo nó (p = 1/4), com um gerador por thread
+    int randomLevel()
+    {
+        thread_local std::minstd_rand rng(std::random_device{}());
+        int level = 1;
+        while (level < SKIPLIST_MAX_LEVEL && (rng() & 3) == 0)
+            level++;
+        return level;
+    }
+
+    // Procura a chave preenchendo, para cada nível, o último nó menor que a chave (preds)
+    // e o primeiro nó maior ou igual (succs). Retorna o nó da chave ou nullptr
+    // As comparações são acumuladas localmente e somadas ao contador uma vez por busca
+    SkipNode<T, Value> *search(const T &key, SkipNode<T, Value> **preds, SkipNode<T, Value> **succs)
+    {
+        uint64_t c = 0;
+        SkipNode<T, Value> *pred = head;
+        SkipNode<T, Value> *curr = nullptr;
+        for (int lvl = SKIPLIST_MAX_LEVEL - 1; lvl >= 0; lvl--)
+        {
+            curr = pred->next[lvl].load(std::memory_order_acquire);
+            while (curr != nullptr)
+            {
+                c++;
+                if (!compare(curr->key, key))
+                    break;
+                pred = curr;
+                curr = pred->next[lvl].load(std::memory_order_acquire);
+            }
+            preds[lvl] = pred;
+            succs[lvl] = curr;
+        }
+
+        SkipNode<T, Value> *found = nullptr;
+        if (curr != nullptr)
+        {
+            c++;
+            if (!compare(key, curr->key))
+                found = curr;
+        }
+        stats.compare(c);
+        return found;
+    }
+
+    // Busca sem registrar o caminho, usada pelas operações de leitura
+    SkipNode<T, Value> *search(const T &key)
+    {
+        SkipNode<T, Value> *preds[SKIPLIST_MAX_LEVEL];
+        SkipNode<T, Value> *succs[SKIPLIST_MAX_LEVEL];
+        SkipNode<T, Value> *node = search(key, preds, succs);
+        if (node != nullptr && node->removed.load(std::memory_order_acquire))
+            return nullptr;
+        return node;
+    }
+
+    // Reativa um nó removido logicamente somando value ao seu contador (zerado na remoção)
+    // Retorna true se esta thread o reativou
+    bool revive(SkipNode<T, Value> *node, Value value)
+    {
+        bool expected = true;
+        if (!node->removed.load(std::memory_order_acquire))
+            return false;
+        if (!node->removed.compare_exchange_strong(expected, false, std::memory_order_acq_rel))
+            return false;
+        _size.fetch_add(1, std::memory_order_relaxed);
+        stats.insert();
+        node->value.fetch_add(value, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Liga um novo nó na lista. Retorna o nó existente (se a chave já estava presente) ou nullptr
+    SkipNode<T, Value> *link(const T &key, Value value)
+    {
+        SkipNode<T, Value> *preds[SKIPLIST_MAX_LEVEL];
+        SkipNode<T, Value> *succs[SKIPLIST_MAX_LEVEL];
+        SkipNode<T, Value> *node = nullptr;
+
+        while (true)
+        {
+            SkipNode<T, Value> *found = search(key, preds, succs);
+            if (found != nullptr)
+            {
+                free_node(node); // Outra thread inseriu a chave primeiro
+                return found;
+            }
+
+            if (node == nullptr)
+                node = make_node(key, value, randomLevel());
+            for (int i = 0; i < node->level; i++)
+                node->next[i].store(succs[i], std::memory_order_relaxed);
+
+            // Ponto de linearização: ligação no nível 0
+            if (preds[0]->next[0].compare_exchange_strong(succs[0], node, std::memory_order_release, std::memory_order_relaxed))
+                break;
+        }
+        _size.fetch_add(1, std::memory_order_relaxed);
+        stats.insert();
+
+        // Liga os níveis superiores, refazendo a busca quando algum vizinho muda
+        for (int i = 1; i < node->level; i++)
+        {
+            while (true)
+            {
+                SkipNode<T, Value> *succ = succs[i];
+                node->next[i].store(succ, std::memory_order_relaxed);
+                if (preds[i]->next[i].compare_exchange_strong(succ, node, std::memory_order_release, std::memory_order_relaxed))
+                    break;
+                search(key, preds, succs);
+            }
+        }
+        return nullptr;
+    }
+
+public:
+    // Construtor da skip list
+    SkipList(COMPARATOR comp = COMPARATOR()) : compare(comp)
+    {
+        head = make_node(T(), Value(), SKIPLIST_MAX_LEVEL);
+    }
+
+    // Destrutor que libera todos os nós
+    ~SkipList()
+    {
+        clear();
+        free_node(head);
+    }
+
+    // Desabilita a cópia da lista
+    SkipList(const SkipList &t) = delete;
+    SkipList &operator=(const SkipList &t) = delete;
+
+    // Função para inserir uma chave na lista (não altera o valor se a chave já existir)
+    bool insert(T key, Value value)
+    {
+        SkipNode<T, Value> *found = link(key, value);
+        return found == nullptr || revive(found, value);
+    }
+
+    // Soma value ao contador da chave, inserindo-a se necessário (seguro entre threads)
+    void add(T key, Value value)
+    {
+        SkipNode<T, Value> *preds[SKIPLIST_MAX_LEVEL];
+        SkipNode<T, Value> *succs[SKIPLIST_MAX_LEVEL];
+        SkipNode<T, Value> *node = search(key, preds, succs);
+        if (node == nullptr)
+        {
+            node = link(key, value);
+            if (node == nullptr)
+                return; // Esta thread inseriu o nó com o valor inicial
+        }
+        if (!revive(node, value))
+            node->value.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    // Função para remover (logicamente) uma chave da lista
+    void remove(T key)
+    {
+        SkipNode<T, Value> *node = search(key);
+        if (node == nullptr)
+            return;
+        bool expected = false;
+        if (node->removed.compare_exchange_strong(expected, true, std::memory_order_acq_rel))
+        {
+            node->value.store(Value(), std::memory_order_relaxed);
+            _size.fetch_sub(1, std::memory_order_relaxed);
+            stats.remove();
+        }
+    }
+
+    // Função para atualizar o valor de uma chave
+    void update(T key, Value value)
+    {
+        SkipNode<T, Value> *node = search(key);
+        if (node != nullptr)
+        {
+            stats.update();
+            node->value.store(value, std::memory_order_relaxed);
+        }
+    }
+
+    // Função para buscar uma chave na lista
+    Value find(T key)
+    {
+        stats.lookup();
+        SkipNode<T, Value> *node = search(key);
+        if (node == nullptr)
+            return Value(); // Retorna um objeto default se não encontrar a chave
+        return node->value.load(std::memory_order_relaxed);
+    }
+
+    // Operador de índice para acessar elementos na lista
+    // Retorna o contador atômico, então 'lista[chave] += 1' é seguro entre threads
+    std::atomic<Value> &operator[](const T &key)
+    {
+        stats.lookup();
+        SkipNode<T, Value> *node = search(key);
+        if (node == nullptr)
+            throw std::out_of_range("Key not found"); // Lança exceção se a chave não for encontrada
+        return node->value;
+    }
+
+    // Função para imprimir a lista em ordem (pode rodar junto com inserções)
+    void print() const
+    {
+        OutputBuffer out;
+        print(out);
+    }
+
+    // Função para imprimir a lista em ordem em um buffer de saída
+    void print(OutputBuffer &out) const
+    {
+        for_each([&out](const T &key, const Value &value)
+                 { out.entry(key, value); });
+    }
+
+    // Chama fn(chave, valor) para cada elemento, em ordem (pode rodar junto com inserções)
+    template <typename F>
+    void for_each(F fn) const
+    {
+        for (SkipNode<T, Value> *node = head->next[0].load(std::memory_order_acquire); node != nullptr;
+             node = node->next[0].load(std::memory_order_acquire))
+        {
+            if (node->removed.load(std::memory_order_acquire))
+                continue;
+            fn(node->key, node->value.load(std::memory_order_relaxed));
+        }
+    }
+
+    // Função que retorna as k chaves de maior valor, da maior para a menor (pode rodar junto com inserções)
+    std::vector<std::pair<T, Value>> top_k(size_t k) const
+    {
+        TopK<T, Value, COMPARATOR> top(k, compare);
+        for (SkipNode<T, Value> *node = head->next[0].load(std::memory_order_acquire); node != nullptr;
+             node = node->next[0].load(std::memory_order_acquire))
+        {
+            if (node->removed.load(std::memory_order_acquire))
+                continue;
+            top.offer(node->key, node->value.load(std::memory_order_relaxed));
+        }
+        return top.result();
+    }
+
+    // Função para limpar a lista (não pode rodar junto com outras operações)
+    void clear()
+    {
+        SkipNode<T, Value> *node = head->next[0].load(std::memory_order_relaxed);
+        while (node != nullptr)
+        {
+            SkipNode<T, Value> *next = node->next[0].load(std::memory_order_relaxed);
+            free_node(node);
+            node = next;
+        }
+        for (int i = 0; i < SKIPLIST_MAX_LEVEL; i++)
+            head->next[i].store(nullptr, std::memory_order_relaxed);
+        _size.store(0, std::memory_order_relaxed);
+    }
+
+    // Função que verifica se a lista contém uma chave
+    bool contains(const T &key)
+    {
+        stats.lookup();
+        return search(key) != nullptr;
+    }
+
+    // Função para retornar o número de comparações feitas
+    size_t comparisons()
+    {
+        return stats.comparisons();
+    }
+
+    // Função que retorna as estatísticas da lista (contadores e número de níveis em uso)
+    // O histograma das buscas fica vazio: ele não seria seguro entre as threads que inserem
+    EngineStats statistics() const
+    {
+        EngineStats s = stats.counters();
+        s.layout = EngineLayout::SkipList;
+        for (int lvl = SKIPLIST_MAX_LEVEL; lvl > 0; lvl--)
+        {
+            if (head->next[lvl - 1].load(std::memory_order_acquire) != nullptr)
+            {
+                s.height = lvl;
+                break;
+            }
+        }
+        s.size = _size.load(std::memory_order_relaxed);
+        return s;
+    }
+
+    // Função que retorna a memória ocupada pelos nós (estrutura, chaves e valores)
+    // Nós removidos logicamente continuam alocados e contam como estrutura
+    MemoryUsage memory() const
+    {
+        return mem.usage(_size.load(std::memory_order_relaxed), sizeof(T), sizeof(std::atomic<Value>));
+    }
+
+    // Função para retornar o número de elementos na lista
+    size_t size() const
+    {
+        return _size.load(std::memory_order_relaxed);
+    }
+};
+
+#endif
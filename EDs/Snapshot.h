@@ -0,0 +1,579 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <iostream>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include "Hash64.h"
+#include "KeyArena.h"
+#include "OutputBuffer.h"
+#include "TopK.h"
+
+// Snapshot binário de um dicionário (palavras e frequências), para carregar sem reler o texto
+//
+// Formato (inteiros na ordem de bytes da máquina, seções alinhadas a 8 bytes):
+//   cabeçalho   SnapshotHeader (64 bytes: assinatura, versão, flags, tamanhos, checksum)
+//   offsets     uint32[count + 1]  início de cada palavra no blob (a última posição é o fim do blob)
+//   counts      uint32[count]      frequência de cada palavra
+//   table       uint32[slots]      (HAS_TABLE) endereçamento aberto: índice + 1 da palavra, 0 = vazio
+//   eytzinger   uint32[count + 1]  (FROZEN) índice da palavra em cada posição da árvore implícita (1 = raiz)
+//   seeds       int32[buckets]     (FROZEN) deslocamento de cada grupo do hash perfeito mínimo
+//   places      uint32[count]      (FROZEN) índice da palavra em cada posição do hash perfeito
+//   blob        bytes UTF-8 das palavras, concatenadas sem separador
+// As palavras ficam na ordem da lista de saída (ordem alfabética do comparador), então print e
+// top_k não precisam de comparações. A tabela usa o hash FNV-1a de 32 bits (WordRef::hash_of) com
+// sondagem linear e fator de carga até 1/2; com ela gravada, a abertura só mapeia o arquivo e as
+// consultas já podem começar. As seções FROZEN são as de FrozenDict (veja FrozenDict.h); com elas, as
+// consultas usam o hash perfeito e a tabela não é necessária. O checksum (FNV-1a de 64 bits de tudo o
+// que vem depois do cabeçalho) é conferido na abertura, se pedido
+struct SnapshotHeader
+{
+    static const uint32_t VERSION = 2;   // Versão 1: sem as seções FROZEN
+    static const uint32_t HAS_TABLE = 1; // A tabela de hash foi gravada
+    static const uint32_t FROZEN = 2;    // A árvore de Eytzinger e o hash perfeito mínimo foram gravados
+
+    char magic[8];         // "GDICTSNP"
+    uint32_t version;      // VERSION
+    uint32_t flags;        // HAS_TABLE, FROZEN
+    uint64_t count;        // Número de palavras
+    uint64_t blob_bytes;   // Tamanho do blob
+    uint64_t slots;        // Posições da tabela (0 se não foi gravada)
+    uint64_t checksum;     // FNV-1a de 64 bits do conteúdo depois do cabeçalho
+    uint64_t buckets;      // Grupos do hash perfeito mínimo (0 se não foi gravado)
+    uint64_t reserved;     // Zero (espaço para versões futuras)
+};
+
+class Snapshot
+{
+private:
+    static constexpr const char *MAGIC = "GDICTSNP";
+    static const size_t BUCKET_SIZE = 4; // Palavras por grupo do hash perfeito, em média
+
+    const char *m_data = nullptr;  // Arquivo inteiro (mapeado ou lido)
+    size_t m_bytes = 0;            // Tamanho do arquivo
+    bool m_mapped = false;         // true se m_data vem de mmap
+    std::vector<char> m_buffer;    // Cópia do arquivo quando não há mmap (ou imagem montada em memória)
+    const SnapshotHeader *m_header = nullptr;
+    const uint32_t *m_offsets = nullptr;
+    const uint32_t *m_counts = nullptr;
+    const uint32_t *m_table = nullptr;
+    const uint32_t *m_eytzinger = nullptr;
+    const int32_t *m_seeds = nullptr;
+    const uint32_t *m_places = nullptr;
+    const char *m_blob = nullptr;
+    std::vector<uint32_t> m_local; // Tabela montada na abertura quando o arquivo não tem nenhum índice
+    size_t m_mask = 0;             // Posições da tabela - 1
+
+    // Arredonda para múltiplo de 8 (alinhamento das seções)
+    static size_t align8(size_t n)
+    {
+        return (n + 7) & ~size_t(7);
+    }
+
+    // Embaralha os bits de um hash (finalizador do splitmix64)
+    static uint64_t mix(uint64_t x)
+    {
+        x ^= x >> 30;
+        x *= 0xbf58476d1ce4e5b9ull;
+        x ^= x >> 27;
+        x *= 0x94d049bb133111ebull;
+        x ^= x >> 31;
+        return x;
+    }
+
+    // Grupo do hash perfeito de uma palavra (h = fnv1a64 da palavra)
+    static size_t mph_bucket(uint64_t h, size_t buckets)
+    {
+        return static_cast<size_t>(mix(h) % buckets);
+    }
+
+    // Posição do hash perfeito de uma palavra com o deslocamento seed
+    static size_t mph_place(uint64_t h, uint64_t seed, size_t count)
+    {
+        return static_cast<size_t>(mix(h + (seed + 1) * 0x9e3779b97f4a7c15ull) % count);
+    }
+
+    // Número de posições da tabela para count palavras (potência de 2, fator de carga até 1/2)
+    static size_t table_slots(size_t count)
+    {
+        size_t slots = 16;
+        while (slots < 2 * count)
+            slots *= 2;
+        return slots;
+    }
+
+    // Número de grupos do hash perfeito para count palavras
+    static size_t mph_buckets(size_t count)
+    {
+        return count == 0 ? 0 : (count + BUCKET_SIZE - 1) / BUCKET_SIZE;
+    }
+
+    // Preenche a tabela (slots posições, zeradas) com as palavras dadas por word(i)
+    template <typename WordOf>
+    static void fill_table(uint32_t *table, size_t slots, size_t count, WordOf word)
+    {
+        size_t mask = slots - 1;
+        for (size_t i = 0; i < count; i++)
+        {
+            size_t s = WordRef::hash_of(word(i)) & mask;
+            while (table[s] != 0)
+                s = (s + 1) & mask;
+            table[s] = static_cast<uint32_t>(i + 1);
+        }
+    }
+
+    // Preenche a árvore de Eytzinger a partir da posição k: a posição k tem filhos 2k e 2k + 1, e o
+    // percurso em ordem visita os índices next, next + 1, ... (a ordem da lista); retorna o próximo índice
+    // A profundidade da recursão é a altura da árvore (log2 count)
+    static uint32_t fill_eytzinger(uint32_t *tree, size_t count, uint32_t next = 0, size_t k = 1)
+    {
+        if (k <= count)
+        {
+            next = fill_eytzinger(tree, count, next, 2 * k);
+            tree[k] = next++;
+            next = fill_eytzinger(tree, count, next, 2 * k + 1);
+        }
+        return next;
+    }
+
+    // Monta o hash perfeito mínimo (hash and displace, como o CHD): as palavras são divididas em grupos;
+    // do maior grupo para o menor, procura o primeiro deslocamento que leva todas as palavras do grupo a
+    // posições livres. Grupos de uma palavra só ocupam diretamente uma posição livre (seed negativo =
+    // -(posição + 1)), então o final da construção não fica procurando as últimas posições livres
+    template <typename WordOf>
+    static void fill_mph(int32_t *seeds, uint32_t *places, size_t buckets, size_t count, WordOf word)
+    {
+        std::vector<uint64_t> hashes(count);
+        std::vector<std::vector<uint32_t>> groups(buckets);
+        for (size_t i = 0; i < count; i++)
+        {
+            hashes[i] = fnv1a64(word(i));
+            groups[mph_bucket(hashes[i], buckets)].push_back(static_cast<uint32_t>(i));
+        }
+        std::vector<uint32_t> order(buckets);
+        for (size_t b = 0; b < buckets; b++)
+            order[b] = static_cast<uint32_t>(b);
+        std::stable_sort(order.begin(), order.end(), [&groups](uint32_t a, uint32_t b)
+                         { return groups[a].size() > groups[b].size(); });
+
+        std::vector<bool> used(count, false);
+        std::vector<size_t> taken;
+        size_t free = 0; // Primeira posição possivelmente livre (grupos de uma palavra)
+        for (uint32_t b : order)
+        {
+            const std::vector<uint32_t> &group = groups[b];
+            if (group.empty())
+            {
+                seeds[b] = 0;
+                continue;
+            }
+            if (group.size() == 1)
+            {
+                while (used[free])
+                    free++;
+                used[free] = true;
+                places[free] = group[0];
+                seeds[b] = -static_cast<int32_t>(free) - 1;
+                continue;
+            }
+            // Duas palavras com o mesmo hash de 64 bits nunca seriam separadas por nenhum deslocamento
+            for (size_t x = 0; x < group.size(); x++)
+            {
+                for (size_t y = x + 1; y < group.size(); y++)
+                {
+                    if (hashes[group[x]] == hashes[group[y]])
+                        throw std::invalid_argument("Snapshot: duplicate word " + std::string(word(group[x])));
+                }
+            }
+            for (uint32_t seed = 0;; seed++)
+            {
+                taken.clear();
+                for (uint32_t i : group)
+                {
+                    size_t p = mph_place(hashes[i], seed, count);
+                    if (used[p] || std::find(taken.begin(), taken.end(), p) != taken.end())
+                        break;
+                    taken.push_back(p);
+                }
+                if (taken.size() < group.size())
+                    continue;
+                for (size_t j = 0; j < group.size(); j++)
+                {
+                    used[taken[j]] = true;
+                    places[taken[j]] = group[j];
+                }
+                seeds[b] = static_cast<int32_t>(seed);
+                break;
+            }
+        }
+    }
+
+    // Carrega o arquivo na memória: mmap no Linux, leitura completa nos outros sistemas
+    // (ou se o mmap falhar)
+    void open(const std::string &path)
+    {
+#ifdef __linux__
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw std::runtime_error("Error opening snapshot " + path);
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0)
+        {
+            void *p = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED)
+            {
+                m_data = static_cast<const char *>(p);
+                m_bytes = static_cast<size_t>(st.st_size);
+                m_mapped = true;
+            }
+        }
+        ::close(fd);
+        if (m_mapped)
+            return;
+#endif
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+            throw std::runtime_error("Error opening snapshot " + path);
+        m_buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        m_data = m_buffer.data();
+        m_bytes = m_buffer.size();
+    }
+
+    // Confere o cabeçalho e os tamanhos das seções e aponta para elas
+    void parse(const std::string &path, bool verify)
+    {
+        if (m_bytes < sizeof(SnapshotHeader))
+            throw std::runtime_error("Invalid snapshot " + path + ": truncated header");
+        m_header = reinterpret_cast<const SnapshotHeader *>(m_data);
+        if (std::memcmp(m_header->magic, MAGIC, sizeof(m_header->magic)) != 0)
+            throw std::runtime_error("Invalid snapshot " + path + ": bad signature");
+        if (m_header->version < 1 || m_header->version > SnapshotHeader::VERSION)
+            throw std::runtime_error("Invalid snapshot " + path + ": unsupported version " + std::to_string(m_header->version));
+
+        uint64_t count = m_header->count;
+        uint64_t slots = (m_header->flags & SnapshotHeader::HAS_TABLE) ? m_header->slots : 0;
+        bool frozen = m_header->version >= 2 && (m_header->flags & SnapshotHeader::FROZEN);
+        uint64_t buckets = frozen ? m_header->buckets : 0;
+        if (count >= UINT32_MAX || slots > (uint64_t(1) << 40) || (slots != 0 && ((slots & (slots - 1)) != 0 || slots < 2 * count)) ||
+            (frozen && buckets != mph_buckets(count)))
+            throw std::runtime_error("Invalid snapshot " + path + ": bad sizes");
+        size_t pos = sizeof(SnapshotHeader);
+        size_t offsets = pos;
+        pos += align8((count + 1) * sizeof(uint32_t));
+        size_t counts = pos;
+        pos += align8(count * sizeof(uint32_t));
+        size_t table = pos;
+        pos += align8(slots * sizeof(uint32_t));
+        size_t eytzinger = pos;
+        size_t seeds = pos;
+        size_t places = pos;
+        if (frozen)
+        {
+            pos += align8((count + 1) * sizeof(uint32_t));
+            seeds = pos;
+            pos += align8(buckets * sizeof(int32_t));
+            places = pos;
+            pos += align8(count * sizeof(uint32_t));
+        }
+        size_t blob = pos;
+        if (m_header->blob_bytes > m_bytes || pos > m_bytes - m_header->blob_bytes)
+            throw std::runtime_error("Invalid snapshot " + path + ": truncated");
+
+        if (verify && fnv1a64(std::string_view(m_data + sizeof(SnapshotHeader), m_bytes - sizeof(SnapshotHeader))) != m_header->checksum)
+            throw std::runtime_error("Invalid snapshot " + path + ": checksum mismatch");
+
+        m_offsets = reinterpret_cast<const uint32_t *>(m_data + offsets);
+        m_counts = reinterpret_cast<const uint32_t *>(m_data + counts);
+        m_blob = m_data + blob;
+        if (m_offsets[count] != m_header->blob_bytes)
+            throw std::runtime_error("Invalid snapshot " + path + ": bad offsets");
+
+        if (frozen)
+        {
+            m_eytzinger = reinterpret_cast<const uint32_t *>(m_data + eytzinger);
+            m_seeds = reinterpret_cast<const int32_t *>(m_data + seeds);
+            m_places = reinterpret_cast<const uint32_t *>(m_data + places);
+        }
+        if (slots != 0)
+            m_table = reinterpret_cast<const uint32_t *>(m_data + table);
+        else if (!frozen)
+        {
+            // Sem nenhum índice no arquivo, a tabela é montada agora (uma passada pelas palavras)
+            m_local.assign(table_slots(count), 0);
+            fill_table(m_local.data(), m_local.size(), count, [this](size_t i)
+                       { return word(i); });
+            m_table = m_local.data();
+            slots = m_local.size();
+        }
+        m_mask = slots == 0 ? 0 : slots - 1;
+    }
+
+    // Aponta para uma imagem já montada em m_buffer
+    void adopt(bool verify)
+    {
+        m_data = m_buffer.data();
+        m_bytes = m_buffer.size();
+        parse("(memória)", verify);
+    }
+
+public:
+    // Abre um snapshot; com verify, confere o checksum (lê o arquivo inteiro)
+    // Lança std::runtime_error se o arquivo não existir ou não for um snapshot válido
+    explicit Snapshot(const std::string &path, bool verify = true)
+    {
+        open(path);
+        try
+        {
+            parse(path, verify);
+        }
+        catch (...)
+        {
+            release();
+            throw;
+        }
+    }
+
+    // Usa uma imagem montada por build (sem arquivo)
+    explicit Snapshot(std::vector<char> image) : m_buffer(std::move(image))
+    {
+        adopt(false);
+    }
+
+    ~Snapshot()
+    {
+        release();
+    }
+
+    // Desabilita a cópia (o mapeamento pertence a uma instância)
+    Snapshot(const Snapshot &s) = delete;
+    Snapshot &operator=(const Snapshot &s) = delete;
+
+    // Desfaz o mapeamento
+    void release()
+    {
+#ifdef __linux__
+        if (m_mapped)
+            munmap(const_cast<char *>(m_data), m_bytes);
+#endif
+        m_mapped = false;
+        m_data = nullptr;
+    }
+
+    // Monta a imagem de um snapshot (cabeçalho e seções) com as palavras e frequências dadas, na ordem
+    // em que devem ser listadas. Com table, inclui a tabela de hash; com frozen, a árvore de Eytzinger
+    // e o hash perfeito mínimo. Lança std::length_error se as palavras não couberem em offsets de 32 bits
+    // e std::invalid_argument se uma palavra se repetir (só com frozen)
+    static std::vector<char> build(const std::vector<std::pair<std::string, uint32_t>> &entries, bool table, bool frozen = false)
+    {
+        uint64_t blob_bytes = 0;
+        for (const auto &e : entries)
+            blob_bytes += e.first.size();
+        if (entries.size() >= UINT32_MAX || blob_bytes > UINT32_MAX)
+            throw std::length_error("Snapshot too large");
+
+        size_t count = entries.size();
+        size_t slots = table ? table_slots(count) : 0;
+        size_t buckets = frozen ? mph_buckets(count) : 0;
+        size_t sizes[] = {sizeof(SnapshotHeader), align8((count + 1) * sizeof(uint32_t)), align8(count * sizeof(uint32_t)),
+                          align8(slots * sizeof(uint32_t)), frozen ? align8((count + 1) * sizeof(uint32_t)) : 0,
+                          align8(buckets * sizeof(int32_t)), frozen ? align8(count * sizeof(uint32_t)) : 0};
+        size_t total = blob_bytes;
+        for (size_t s : sizes)
+            total += s;
+        std::vector<char> image(total, 0);
+        char *section[8];
+        section[0] = image.data();
+        for (size_t s = 1; s < 8; s++)
+            section[s] = section[s - 1] + sizes[s - 1];
+
+        uint32_t *offsets = reinterpret_cast<uint32_t *>(section[1]);
+        uint32_t *counts = reinterpret_cast<uint32_t *>(section[2]);
+        char *blob = section[7];
+        uint32_t offset = 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            offsets[i] = offset;
+            counts[i] = entries[i].second;
+            std::memcpy(blob + offset, entries[i].first.data(), entries[i].first.size());
+            offset += static_cast<uint32_t>(entries[i].first.size());
+        }
+        offsets[count] = offset;
+        auto word = [&entries](size_t i)
+        { return std::string_view(entries[i].first); };
+        if (table)
+            fill_table(reinterpret_cast<uint32_t *>(section[3]), slots, count, word);
+        if (frozen)
+        {
+            reinterpret_cast<uint32_t *>(section[4])[0] = static_cast<uint32_t>(count); // Posição 0 sem uso
+            fill_eytzinger(reinterpret_cast<uint32_t *>(section[4]), count);
+            fill_mph(reinterpret_cast<int32_t *>(section[5]), reinterpret_cast<uint32_t *>(section[6]), buckets, count, word);
+        }
+
+        SnapshotHeader header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, MAGIC, sizeof(header.magic));
+        header.version = SnapshotHeader::VERSION;
+        header.flags = (table ? SnapshotHeader::HAS_TABLE : 0) | (frozen ? SnapshotHeader::FROZEN : 0);
+        header.count = count;
+        header.blob_bytes = blob_bytes;
+        header.slots = slots;
+        header.buckets = buckets;
+        header.checksum = fnv1a64(std::string_view(image.data() + sizeof(header), image.size() - sizeof(header)));
+        std::memcpy(image.data(), &header, sizeof(header));
+        return image;
+    }
+
+    // Grava um snapshot com as palavras e frequências dadas (na ordem em que devem ser listadas)
+    // Com table, grava também a tabela de hash, para que a abertura não precise montá-la
+    static bool save(const std::string &path, const std::vector<std::pair<std::string, uint32_t>> &entries, bool table = true)
+    {
+        std::vector<char> image;
+        try
+        {
+            image = build(entries, table);
+        }
+        catch (std::length_error &e)
+        {
+            return false;
+        }
+        std::ofstream file(path, std::ios::binary);
+        file.write(image.data(), static_cast<std::streamsize>(image.size()));
+        return static_cast<bool>(file);
+    }
+
+    // Grava a imagem aberta (arquivo mapeado ou montada em memória) em outro arquivo
+    bool save(const std::string &path) const
+    {
+        std::ofstream file(path, std::ios::binary);
+        file.write(m_data, static_cast<std::streamsize>(m_bytes));
+        return static_cast<bool>(file);
+    }
+
+    // Número de palavras
+    size_t size() const
+    {
+        return static_cast<size_t>(m_header->count);
+    }
+
+    // Palavra de posição i (na ordem da lista)
+    std::string_view word(size_t i) const
+    {
+        return std::string_view(m_blob + m_offsets[i], m_offsets[i + 1] - m_offsets[i]);
+    }
+
+    // Frequência da palavra de posição i
+    uint32_t count(size_t i) const
+    {
+        return m_counts[i];
+    }
+
+    // Posição de uma palavra na lista (size() se ela não estiver no snapshot)
+    // Usa o hash perfeito quando há (uma posição, uma comparação), senão a tabela de hash
+    size_t index(std::string_view w) const
+    {
+        size_t n = size();
+        if (m_places != nullptr)
+        {
+            if (n == 0)
+                return n;
+            uint64_t h = fnv1a64(w);
+            int32_t seed = m_seeds[mph_bucket(h, static_cast<size_t>(m_header->buckets))];
+            size_t place = seed < 0 ? static_cast<size_t>(-(seed + 1)) : mph_place(h, static_cast<uint64_t>(seed), n);
+            size_t i = m_places[place];
+            return word(i) == w ? i : n;
+        }
+        size_t s = WordRef::hash_of(w) & m_mask;
+        while (m_table[s] != 0)
+        {
+            size_t i = m_table[s] - 1;
+            if (word(i) == w)
+                return i;
+            s = (s + 1) & m_mask;
+        }
+        return n;
+    }
+
+    // Frequência de uma palavra (0 se ela não estiver no snapshot)
+    uint32_t find(std::string_view w) const
+    {
+        size_t i = index(w);
+        return i < size() ? m_counts[i] : 0;
+    }
+
+    bool contains(std::string_view w) const
+    {
+        return index(w) < size();
+    }
+
+    // Verifica se a consulta não precisou montar nenhum índice na abertura
+    bool has_table() const
+    {
+        return m_local.empty();
+    }
+
+    // Verifica se o snapshot tem as seções de FrozenDict
+    bool frozen() const
+    {
+        return m_places != nullptr;
+    }
+
+    // Árvore de Eytzinger (posições 1 a size(); nulo se o snapshot não for FROZEN)
+    const uint32_t *eytzinger() const
+    {
+        return m_eytzinger;
+    }
+
+    // Verifica se o arquivo foi mapeado (mmap) em vez de lido
+    bool mapped() const
+    {
+        return m_mapped;
+    }
+
+    // Tamanho do arquivo, em bytes
+    size_t bytes() const
+    {
+        return m_bytes;
+    }
+
+    // Tamanho do blob (texto das palavras), em bytes
+    size_t blob_bytes() const
+    {
+        return static_cast<size_t>(m_header->blob_bytes);
+    }
+
+    // Imprime as palavras na ordem gravada, com as frequências
+    void print(OutputBuffer &out) const
+    {
+        for (size_t i = 0; i < size(); i++)
+            out.entry(word(i), m_counts[i]);
+        out << '\n';
+    }
+
+    // Retorna as k palavras mais frequentes (empates na ordem da lista, como nas estruturas)
+    std::vector<std::pair<std::string_view, uint32_t>> top_k(size_t k) const
+    {
+        TopK<uint32_t, uint32_t, std::less<uint32_t>> top(k);
+        for (size_t i = 0; i < size(); i++)
+            top.offer(static_cast<uint32_t>(i), m_counts[i]);
+        std::vector<std::pair<std::string_view, uint32_t>> result;
+        for (const auto &p : top.result())
+            result.emplace_back(word(p.first), p.second);
+        return result;
+    }
+};
+
+#endif
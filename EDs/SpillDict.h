@@ -0,0 +1,285 @@
+#ifndef SPILLDICT_H
+#define SPILLDICT_H
+
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <memory>
+#include <queue>
+#include <random>
+#include <string>
+#include <vector>
+#include "Dict.h"
+#include "TopK.h"
+
+// Dicionário com transbordo para o disco (memória externa)
+// As palavras são inseridas em um Dict comum; quando a memória estimada dele passa do limite, o
+// conteúdo é gravado em ordem em um arquivo temporário (um "run", no mesmo formato da lista de
+// palavras) e um Dict novo é criado. No final, os runs são intercalados (k-way merge com uma fila
+// de prioridade e o comparador da estrutura), somando as frequências da mesma palavra, em um
+// arquivo final que é lido por print e top_k. Assim a memória fica limitada pelo orçamento
+// e pelo número de runs, e não pelo tamanho do vocabulário
+template <typename EDType>
+class SpillDict
+{
+private:
+    typedef typename comparator_of<EDType>::type Comparator;
+
+    // Intervalo (em inserções) entre as verificações do orçamento
+    static const size_t CHECK_INTERVAL = 1024;
+
+    // Linha de um run sendo intercalado
+    struct Head
+    {
+        std::string word; // Palavra
+        long long count;  // Frequência
+        size_t run;       // Run de onde veio a linha
+    };
+
+    std::unique_ptr<Dict<EDType>> _dict;     // Parte em memória
+    size_t _budget = 0;                      // Limite de memória da parte em memória (0 = sem limite)
+    size_t _pending = 0;                     // Inserções desde a última verificação do orçamento
+    std::vector<std::filesystem::path> _runs; // Runs gravados em disco
+    std::filesystem::path _merged;           // Resultado da intercalação (vazio enquanto não for feita)
+    std::string _prefix;                     // Prefixo dos arquivos temporários desta instância
+    size_t _size = 0;                        // Número de palavras distintas (depois da intercalação)
+    size_t comps = 0;                        // Comparações das estruturas já descartadas e da intercalação
+    Comparator _compare;                     // Comparador da ordem das palavras (criado uma única vez)
+
+    // Memória da parte em memória (medida pelo alocador da estrutura, mais a arena)
+    size_t _bytes()
+    {
+        return _dict->memory().total();
+    }
+
+    // Cria um caminho temporário novo
+    std::filesystem::path _temp(const std::string &name)
+    {
+        return std::filesystem::temp_directory_path() / (_prefix + name);
+    }
+
+    // Grava a parte em memória como um run ordenado e recomeça com uma estrutura vazia
+    void _spill()
+    {
+        if (_dict->size() == 0)
+            return;
+        std::filesystem::path path = _temp("run" + std::to_string(_runs.size()) + ".txt");
+        {
+            std::ofstream file(path, std::ios::binary);
+            if (!file)
+                throw std::runtime_error("Error opening spill file " + path.string());
+            OutputBuffer out(file);
+            _dict->print(out);
+        }
+        _runs.push_back(path);
+        comps += _dict->comparisons();
+        _dict.reset(new Dict<EDType>());
+    }
+
+    // Lê a próxima linha "palavra: frequência" de um run; retorna false no fim do arquivo
+    static bool _read(std::ifstream &file, Head &head)
+    {
+        std::string line;
+        while (std::getline(file, line))
+        {
+            size_t sep = line.rfind(": ");
+            if (sep == std::string::npos)
+                continue; // Linha vazia no fim da lista
+            head.word = line.substr(0, sep);
+            head.count = std::stoll(line.substr(sep + 2));
+            return true;
+        }
+        return false;
+    }
+
+    // Intercala os runs em um único arquivo ordenado, somando as frequências da mesma palavra
+    void _merge()
+    {
+        if (!_merged.empty())
+            return;
+        _spill();
+
+        auto greater = [this](const Head &a, const Head &b)
+        {
+            comps++;
+            if (a.word == b.word)
+                return a.run > b.run;
+            return _compare(b.word, a.word);
+        };
+        std::priority_queue<Head, std::vector<Head>, decltype(greater)> heap(greater);
+
+        std::vector<std::ifstream> files;
+        for (size_t r = 0; r < _runs.size(); r++)
+        {
+            files.emplace_back(_runs[r], std::ios::binary);
+            Head head{"", 0, r};
+            if (_read(files[r], head))
+                heap.push(head);
+        }
+
+        _merged = _temp("merged.txt");
+        std::ofstream file(_merged, std::ios::binary);
+        if (!file)
+            throw std::runtime_error("Error opening spill file " + _merged.string());
+        OutputBuffer out(file);
+        _size = 0;
+        while (!heap.empty())
+        {
+            Head current = heap.top();
+            heap.pop();
+            Head next{"", 0, current.run};
+            if (_read(files[current.run], next))
+                heap.push(next);
+
+            // Soma a mesma palavra vinda dos outros runs (que estão no topo da fila)
+            while (!heap.empty() && heap.top().word == current.word)
+            {
+                Head same = heap.top();
+                heap.pop();
+                current.count += same.count;
+                Head after{"", 0, same.run};
+                if (_read(files[same.run], after))
+                    heap.push(after);
+            }
+            out.entry(current.word, current.count);
+            _size++;
+        }
+
+        // Os runs já intercalados não são mais necessários
+        files.clear();
+        for (const auto &path : _runs)
+            std::filesystem::remove(path);
+    }
+
+    // Converte uma chave da estrutura para texto UTF-8
+    static std::string _utf8(const WordRef &key)
+    {
+        return std::string(key.view());
+    }
+
+    static std::string _utf8(const icu::UnicodeString &key)
+    {
+        std::string utf8;
+        key.toUTF8String(utf8);
+        return utf8;
+    }
+
+    // Remove todos os arquivos temporários
+    void _remove_files()
+    {
+        std::error_code ec;
+        for (const auto &path : _runs)
+            std::filesystem::remove(path, ec);
+        if (!_merged.empty())
+            std::filesystem::remove(_merged, ec);
+        _runs.clear();
+        _merged.clear();
+    }
+
+public:
+    SpillDict() : _dict(new Dict<EDType>())
+    {
+        std::random_device rd;
+        _prefix = "generic_dict_" + std::to_string(rd()) + "_" + std::to_string(rd()) + "_";
+    }
+
+    // Destrutor que apaga os arquivos temporários
+    ~SpillDict()
+    {
+        _remove_files();
+    }
+
+    // Desabilita a cópia do dicionário (os arquivos temporários pertencem a esta instância)
+    SpillDict(const SpillDict &d) = delete;
+    SpillDict &operator=(const SpillDict &d) = delete;
+
+    // Define o limite de memória da parte em memória, em bytes (0 = sem limite)
+    void budget(size_t bytes)
+    {
+        _budget = bytes;
+    }
+
+    // Soma value à frequência da palavra (não pode ser chamada depois de print, size ou top_k)
+    template <typename Word>
+    void add(const Word &word, unsigned int value = 1)
+    {
+        if (!_merged.empty())
+            throw std::logic_error("SpillDict already merged");
+        _dict->add(word, value);
+        if (_budget > 0 && ++_pending >= CHECK_INTERVAL)
+        {
+            _pending = 0;
+            if (_bytes() > _budget)
+                _spill();
+        }
+    }
+
+    void clear()
+    {
+        _remove_files();
+        _dict.reset(new Dict<EDType>());
+        _size = 0;
+        comps = 0;
+    }
+
+    // Número de palavras distintas (intercala os runs, se ainda não foram intercalados)
+    size_t size()
+    {
+        if (_runs.empty() && _merged.empty())
+            return _dict->size();
+        _merge();
+        return _size;
+    }
+
+    size_t comparisons()
+    {
+        return comps + _dict->comparisons();
+    }
+
+    // Número de runs gravados em disco
+    size_t runs() const
+    {
+        return _runs.size();
+    }
+
+    // Retorna as k palavras mais frequentes, da mais frequente para a menos frequente
+    std::vector<std::pair<std::string, long long>> top_k(size_t k)
+    {
+        TopK<std::string, long long, Comparator> top(k, _compare);
+        if (_runs.empty() && _merged.empty())
+        {
+            for (const auto &p : _dict->top_k(k))
+                top.offer(_utf8(p.first), p.second);
+            return top.result();
+        }
+        _merge();
+        std::ifstream file(_merged, std::ios::binary);
+        Head head;
+        while (_read(file, head))
+            top.offer(head.word, head.count);
+        return top.result();
+    }
+
+    void print()
+    {
+        OutputBuffer out;
+        print(out);
+    }
+
+    // Imprime as palavras em ordem com as suas frequências em um buffer de saída
+    void print(OutputBuffer &out)
+    {
+        if (_runs.empty() && _merged.empty())
+        {
+            _dict->print(out);
+            return;
+        }
+        _merge();
+        std::ifstream file(_merged, std::ios::binary);
+        std::vector<char> buffer(1 << 16);
+        while (file.read(buffer.data(), buffer.size()) || file.gcount() > 0)
+            out.write(buffer.data(), static_cast<size_t>(file.gcount()));
+    }
+};
+
+#endif
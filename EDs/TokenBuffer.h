@@ -0,0 +1,60 @@
+#ifndef TOKENBUFFER_H
+#define TOKENBUFFER_H
+
+#include <iostream>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Palavras de um texto já dividido, guardadas em um único buffer para serem inseridas várias vezes
+// Os bytes de todas as palavras ficam um após o outro em m_bytes, e m_offsets guarda onde cada uma
+// começa (a palavra i vai de m_offsets[i] até m_offsets[i + 1]): 4 bytes por palavra além do texto,
+// sem uma alocação por palavra como em std::vector<std::string>
+class TokenBuffer
+{
+private:
+    std::string m_bytes;
+    std::vector<uint32_t> m_offsets{0};
+
+public:
+    // Divide o texto em palavras (separadas por espaços, como o operador >> do main)
+    static TokenBuffer tokenize(std::istream &in)
+    {
+        TokenBuffer tokens;
+        std::string word;
+        while (in >> word)
+            tokens.push(word);
+        return tokens;
+    }
+
+    // Acrescenta uma palavra no fim
+    void push(std::string_view word)
+    {
+        if (m_bytes.size() + word.size() > UINT32_MAX)
+            throw std::length_error("token buffer too large");
+        m_bytes.append(word.data(), word.size());
+        m_offsets.push_back(static_cast<uint32_t>(m_bytes.size()));
+    }
+
+    // Número de palavras
+    size_t size() const
+    {
+        return m_offsets.size() - 1;
+    }
+
+    // Palavra de índice i (válida enquanto o buffer existir e não receber outras palavras)
+    std::string_view operator[](size_t i) const
+    {
+        return std::string_view(m_bytes.data() + m_offsets[i], m_offsets[i + 1] - m_offsets[i]);
+    }
+
+    // Memória ocupada pelas palavras e pelos inícios, em bytes
+    size_t bytes() const
+    {
+        return m_bytes.capacity() + m_offsets.capacity() * sizeof(uint32_t);
+    }
+};
+
+#endif
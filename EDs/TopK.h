@@ -0,0 +1,68 @@
+#ifndef TOPK_H
+#define TOPK_H
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+// Seleção das k chaves de maior valor (palavras mais frequentes) sem ordenar todas as chaves
+// Mantém um heap de mínimo limitado a k elementos: cada chave oferecida custa O(log k) e a
+// maioria é descartada com uma única comparação de valores, então o total é O(n log k).
+// Em caso de empate no valor, vem primeiro a chave menor segundo o comparador
+template <typename Key, typename Value, typename COMPARATOR>
+class TopK
+{
+private:
+    static constexpr size_t INITIAL_CAPACITY = 1024; // Posições reservadas de início no heap
+
+    size_t m_k;                                // Número de chaves a selecionar
+    COMPARATOR compare;                        // Função de comparação das chaves (desempate)
+    std::vector<std::pair<Key, Value>> m_heap; // Heap cuja frente é a pior chave selecionada até agora
+
+    // Verifica se a deve vir antes de b no resultado (maior valor, depois menor chave)
+    bool better(const std::pair<Key, Value> &a, const std::pair<Key, Value> &b) const
+    {
+        if (b.second < a.second)
+            return true;
+        return !(a.second < b.second) && compare(a.first, b.first);
+    }
+
+public:
+    // k pode passar do número de chaves oferecidas (--top=N grande): o heap só reserva as primeiras
+    // posições e cresce com as chaves que de fato chegam
+    TopK(size_t k, COMPARATOR comp = COMPARATOR()) : m_k(k), compare(comp)
+    {
+        m_heap.reserve(std::min(k, INITIAL_CAPACITY));
+    }
+
+    // Oferece uma chave à seleção
+    void offer(const Key &key, const Value &value)
+    {
+        if (m_k == 0)
+            return;
+        auto cmp = [this](const std::pair<Key, Value> &a, const std::pair<Key, Value> &b)
+        { return better(a, b); };
+        if (m_heap.size() < m_k)
+        {
+            m_heap.emplace_back(key, value);
+            std::push_heap(m_heap.begin(), m_heap.end(), cmp);
+        }
+        else if (!(value < m_heap.front().second) && better({key, value}, m_heap.front()))
+        {
+            std::pop_heap(m_heap.begin(), m_heap.end(), cmp);
+            m_heap.back() = {key, value};
+            std::push_heap(m_heap.begin(), m_heap.end(), cmp);
+        }
+    }
+
+    // Retorna as chaves selecionadas, da mais frequente para a menos frequente
+    std::vector<std::pair<Key, Value>> result() const
+    {
+        std::vector<std::pair<Key, Value>> sorted(m_heap);
+        std::sort(sorted.begin(), sorted.end(), [this](const std::pair<Key, Value> &a, const std::pair<Key, Value> &b)
+                  { return better(a, b); });
+        return sorted;
+    }
+};
+
+#endif
@@ -0,0 +1,180 @@
+#ifndef TRACKINGALLOCATOR_H
+#define TRACKINGALLOCATOR_H
+
+#include <iostream>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "OutputBuffer.h"
+
+// Memória ocupada por uma estrutura, separada em estrutura, chaves e valores
+struct MemoryUsage
+{
+    size_t structure = 0;      // Nós, buckets e posições, sem as chaves e os valores guardados neles
+    size_t keys = 0;           // Chaves (o próprio objeto da chave e o texto na arena, quando há)
+    size_t values = 0;         // Valores
+    uint64_t allocations = 0;  // Número de alocações
+    uint64_t deallocations = 0; // Número de liberações
+    size_t peak = 0;           // Maior quantidade de memória alocada ao mesmo tempo (sem a arena)
+
+    size_t total() const
+    {
+        return structure + keys + values;
+    }
+
+    // Bytes por chave distinta (0 se a estrutura estiver vazia)
+    double per_key(size_t size) const
+    {
+        return size == 0 ? 0.0 : static_cast<double>(total()) / size;
+    }
+
+    // Imprime a memória no cabeçalho da saída
+    void print(OutputBuffer &out, size_t size) const
+    {
+        out << "Memória usada: " << total() << " bytes (estrutura " << structure << ", chaves " << keys
+            << ", valores " << values << ")" << '\n';
+        out << "Bytes por palavra: " << per_key(size) << '\n';
+        out << "Alocações: " << allocations << " (liberações " << deallocations << ", pico " << peak << " bytes)" << '\n';
+    }
+
+    // Grava em JSON (um objeto, sem quebra de linha)
+    void write_json(std::ostream &os, size_t size) const
+    {
+        os << "{\"total\": " << total() << ", \"structure\": " << structure << ", \"keys\": " << keys
+           << ", \"values\": " << values << ", \"bytes_per_key\": " << per_key(size)
+           << ", \"allocations\": " << allocations << ", \"deallocations\": " << deallocations
+           << ", \"peak\": " << peak << "}";
+    }
+};
+
+// Contador das alocações de uma estrutura (seguro entre threads, como as inserções da SkipList)
+class MemoryCounter
+{
+private:
+    std::atomic<uint64_t> m_allocations{0};
+    std::atomic<uint64_t> m_deallocations{0};
+    std::atomic<size_t> m_live{0}; // Bytes alocados e ainda não liberados
+    std::atomic<size_t> m_peak{0};
+
+public:
+    void allocated(size_t bytes)
+    {
+        m_allocations.fetch_add(1, std::memory_order_relaxed);
+        size_t live = m_live.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        size_t peak = m_peak.load(std::memory_order_relaxed);
+        while (live > peak && !m_peak.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    void released(size_t bytes)
+    {
+        m_deallocations.fetch_add(1, std::memory_order_relaxed);
+        m_live.fetch_sub(bytes, std::memory_order_relaxed);
+    }
+
+    size_t live() const
+    {
+        return m_live.load(std::memory_order_relaxed);
+    }
+
+    // Divide a memória viva entre estrutura, chaves e valores
+    // As chaves e os valores de elements elementos saem da memória viva; o resto é estrutura
+    // (ponteiros, alturas, cores, posições vazias, blocos de controle)
+    MemoryUsage usage(size_t elements, size_t key_size, size_t value_size) const
+    {
+        MemoryUsage m;
+        m.keys = elements * key_size;
+        m.values = elements * value_size;
+        size_t bytes = live();
+        m.structure = bytes > m.keys + m.values ? bytes - m.keys - m.values : 0;
+        m.allocations = m_allocations.load(std::memory_order_relaxed);
+        m.deallocations = m_deallocations.load(std::memory_order_relaxed);
+        m.peak = m_peak.load(std::memory_order_relaxed);
+        return m;
+    }
+};
+
+// Alocador que repassa para std::allocator e registra cada alocação em um MemoryCounter
+// Pode ser usado pelos contêineres da biblioteca padrão (std::list, std::vector, std::allocate_shared)
+// CounterPtr é o ponteiro guardado para o contador: std::shared_ptr<MemoryCounter> quando as alocações
+// podem viver mais que a estrutura (nós compartilhados com snapshots)
+template <typename T, typename CounterPtr = MemoryCounter *>
+class TrackingAllocator
+{
+private:
+    CounterPtr m_counter;
+
+    template <typename U, typename P>
+    friend class TrackingAllocator;
+
+public:
+    typedef T value_type;
+    typedef std::true_type propagate_on_container_move_assignment; // A tabela reconstruída leva o contador junto
+    typedef std::true_type propagate_on_container_swap;
+
+    TrackingAllocator(CounterPtr counter = nullptr) noexcept : m_counter(counter) {}
+
+    template <typename U>
+    TrackingAllocator(const TrackingAllocator<U, CounterPtr> &other) noexcept : m_counter(other.m_counter) {}
+
+    T *allocate(size_t n)
+    {
+        T *p = std::allocator<T>().allocate(n);
+        if (m_counter != nullptr)
+            m_counter->allocated(n * sizeof(T));
+        return p;
+    }
+
+    void deallocate(T *p, size_t n)
+    {
+        if (m_counter != nullptr)
+            m_counter->released(n * sizeof(T));
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    template <typename U>
+    bool operator==(const TrackingAllocator<U, CounterPtr> &other) const
+    {
+        return m_counter == other.m_counter;
+    }
+
+    template <typename U>
+    bool operator!=(const TrackingAllocator<U, CounterPtr> &other) const
+    {
+        return m_counter != other.m_counter;
+    }
+};
+
+// Cria um objeto (como new T(args...)) registrando a alocação no contador
+template <typename T, typename... Args>
+T *tracked_new(MemoryCounter &counter, Args &&...args)
+{
+    TrackingAllocator<T> alloc(&counter);
+    T *p = alloc.allocate(1);
+    try
+    {
+        ::new (static_cast<void *>(p)) T(std::forward<Args>(args)...);
+    }
+    catch (...)
+    {
+        alloc.deallocate(p, 1);
+        throw;
+    }
+    return p;
+}
+
+// Destrói um objeto criado por tracked_new (como delete p)
+template <typename T>
+void tracked_delete(MemoryCounter &counter, T *p)
+{
+    if (p == nullptr)
+        return;
+    p->~T();
+    TrackingAllocator<T>(&counter).deallocate(p, 1);
+}
+
+#endif
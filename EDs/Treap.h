@@ -0,0 +1,361 @@
+#ifndef TREAP_H
+#define TREAP_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <random>
+#include <unicode/unistr.h>
+#include <unicode/ustream.h>
+#include <unicode/ucnv.h>
+#include <unicode/coll.h>
+#include "extras.h"
+#include "OutputBuffer.h"
+#include "TopK.h"
+#include "EngineStats.h"
+#include "TrackingAllocator.h"
+
+// Estrutura de nó da Treap
+template <typename T, typename Value>
+struct TreapNode
+{
+    std::pair<T, Value> key;    // Chave do nó de par Chave/Valor
+    TreapNode<T, Value> *left;  // Ponteiro para o filho esquerdo
+    TreapNode<T, Value> *right; // Ponteiro para o filho direito
+    unsigned int prio;          // Prioridade aleatória usada para desempate entre frequências iguais
+
+    // Construtor do nó
+    TreapNode(T k, Value v, unsigned int p) : key({k, v}), left(nullptr), right(nullptr), prio(p) {}
+};
+
+// Implementação de uma Treap ponderada pela frequência
+// A árvore é uma árvore de busca pelas chaves e um heap de máximo pelos valores (contadores),
+// então as palavras mais frequentes do texto (lei de Zipf) sobem para perto da raiz e custam
+// poucas comparações nos acessos seguintes. O valor deve ser comparável com '<' e '=='
+template <typename T, typename Value = int, typename COMPARATOR = comparator<T>, typename Stats = CountingStats>
+class Treap
+{
+private:
+    TreapNode<T, Value> *root = nullptr; // Raiz da árvore
+    COMPARATOR compare;                  // Função de comparação personalizada
+    Stats stats;                         // Contadores de operações e comparações
+    MemoryCounter mem;                   // Memória alocada pelos nós
+    unsigned int _size = 0;              // Número de elementos na árvore
+    std::minstd_rand rng;                // Gerador das prioridades de desempate (semente fixa, execução determinística)
+    std::vector<TreapNode<T, Value> **> path; // Ponteiros de ligação do último caminho percorrido (reutilizado entre operações)
+
+    // Verifica se o nó a deve ficar acima do nó b no heap (maior frequência, depois maior prioridade)
+    bool higher(TreapNode<T, Value> *a, TreapNode<T, Value> *b) const
+    {
+        if (b->key.second < a->key.second)
+            return true;
+        return a->key.second == b->key.second && a->prio > b->prio;
+    }
+
+    // Desce pela árvore guardando os ponteiros de ligação do caminho (path[0] é &root)
+    // Retorna o ponteiro de ligação onde a chave está (ou onde deveria ser inserida)
+    TreapNode<T, Value> **descend(const T &key)
+    {
+        path.clear();
+        TreapNode<T, Value> **slot = &root;
+        while (*slot != nullptr)
+        {
+            TreapNode<T, Value> *node = *slot;
+            path.push_back(slot);
+            stats.visit();
+            stats.compare();
+            if (compare(key, node->key.first))
+            {
+                slot = &node->left;
+            }
+            else if (compare(node->key.first, key))
+            {
+                stats.compare();
+                slot = &node->right;
+            }
+            else
+            {
+                stats.compare();
+                path.pop_back();
+                stats.end_search();
+                return slot;
+            }
+        }
+        stats.end_search();
+        return slot;
+    }
+
+    // Sobe o nó ligado em slot (no fim do caminho) com rotações enquanto ele for mais frequente que o pai
+    TreapNode<T, Value> *bubbleUp(TreapNode<T, Value> **slot)
+    {
+        TreapNode<T, Value> *node = *slot;
+        while (!path.empty() && higher(node, *path.back()))
+        {
+            TreapNode<T, Value> **parentSlot = path.back();
+            TreapNode<T, Value> *parent = *parentSlot;
+            path.pop_back();
+            stats.rotation(false);
+            if (parent->left == node)
+            {
+                // Rotação à direita
+                parent->left = node->right;
+                node->right = parent;
+            }
+            else
+            {
+                // Rotação à esquerda
+                parent->right = node->left;
+                node->left = parent;
+            }
+            *parentSlot = node;
+        }
+        return node;
+    }
+
+    // Desce o nó ligado em slot com rotações até que nenhum filho seja mais frequente que ele
+    // Com remove = true, desce até virar folha e remove o nó
+    void siftDown(TreapNode<T, Value> **slot, bool remove)
+    {
+        TreapNode<T, Value> *node = *slot;
+        while (node->left != nullptr || node->right != nullptr)
+        {
+            TreapNode<T, Value> *child;
+            if (node->left == nullptr)
+                child = node->right;
+            else if (node->right == nullptr)
+                child = node->left;
+            else
+                child = higher(node->left, node->right) ? node->left : node->right;
+
+            if (!remove && !higher(child, node))
+                break;
+
+            stats.rotation(false);
+            if (child == node->left)
+            {
+                node->left = child->right;
+                child->right = node;
+                *slot = child;
+                slot = &child->right;
+            }
+            else
+            {
+                node->right = child->left;
+                child->left = node;
+                *slot = child;
+                slot = &child->left;
+            }
+        }
+        if (remove)
+        {
+            *slot = nullptr;
+            tracked_delete(mem, node);
+        }
+    }
+
+    // Função auxiliar que percorre a árvore em ordem (iterativa), chamando fn(chave, valor)
+    template <typename F>
+    void _for_each(TreapNode<T, Value> *node, F &fn) const
+    {
+        std::vector<TreapNode<T, Value> *> stack;
+        while (node != nullptr || !stack.empty())
+        {
+            while (node != nullptr)
+            {
+                stack.push_back(node);
+                node = node->left;
+            }
+            node = stack.back();
+            stack.pop_back();
+            fn(node->key.first, node->key.second);
+            node = node->right;
+        }
+    }
+
+    // Função auxiliar para limpar a árvore (iterativa)
+    void _clear(TreapNode<T, Value> *node)
+    {
+        std::vector<TreapNode<T, Value> *> stack;
+        if (node != nullptr)
+            stack.push_back(node);
+        while (!stack.empty())
+        {
+            node = stack.back();
+            stack.pop_back();
+            if (node->left != nullptr)
+                stack.push_back(node->left);
+            if (node->right != nullptr)
+                stack.push_back(node->right);
+            tracked_delete(mem, node);
+        }
+    }
+
+public:
+    // Construtor da Treap
+    Treap(COMPARATOR comp = COMPARATOR()) : compare(comp)
+    {
+        root = nullptr;
+        _size = 0;
+    }
+
+    // Destrutor que libera todos os nós
+    ~Treap()
+    {
+        clear();
+    }
+
+    // Desabilita a cópia da árvore
+    Treap(const Treap &t) = delete;
+    Treap &operator=(const Treap &t) = delete;
+
+    // Função para inserir uma chave na árvore
+    void insert(T key, Value value)
+    {
+        TreapNode<T, Value> **slot = descend(key);
+        if (*slot != nullptr)
+            return;
+
+        *slot = tracked_new<TreapNode<T, Value>>(mem, key, value, rng());
+        _size++;
+        stats.insert();
+        bubbleUp(slot);
+    }
+
+    // Função para remover uma chave da árvore
+    void remove(T key)
+    {
+        TreapNode<T, Value> **slot = descend(key);
+        if (*slot == nullptr)
+            return;
+
+        siftDown(slot, true);
+        _size--;
+        stats.remove();
+    }
+
+    // Função para atualizar a frequência de uma chave, reposicionando o nó no heap
+    void update(T key, Value value)
+    {
+        TreapNode<T, Value> **slot = descend(key);
+        if (*slot == nullptr)
+            return;
+
+        stats.update();
+        (*slot)->key.second = value;
+        size_t depth = path.size();
+        bubbleUp(slot);
+        if (path.size() == depth)
+            siftDown(slot, false); // O nó não subiu, talvez precise descer
+    }
+
+    // Função para buscar uma chave na árvore
+    Value find(T key)
+    {
+        stats.lookup();
+        TreapNode<T, Value> **slot = descend(key);
+        if (*slot == nullptr)
+            return Value(); // Retorna um objeto default se não encontrar a chave
+        return (*slot)->key.second;
+    }
+
+    // Operador de índice para acessar elementos na árvore
+    // O valor pode ser alterado pela referência retornada (ex.: contador += 1), então a posição
+    // do nó no heap é corrigida de forma preguiçosa, no acesso seguinte à mesma chave
+    Value &operator[](const T &key)
+    {
+        stats.lookup();
+        TreapNode<T, Value> **slot = descend(key);
+        if (*slot == nullptr)
+            throw std::out_of_range("Key not found"); // Lança exceção se a chave não for encontrada
+        return bubbleUp(slot)->key.second;
+    }
+
+    // Função para imprimir a árvore
+    void print() const
+    {
+        OutputBuffer out;
+        print(out);
+    }
+
+    // Função para imprimir a árvore em um buffer de saída
+    void print(OutputBuffer &out) const
+    {
+        for_each([&out](const T &key, const Value &value)
+                 { out.entry(key, value); });
+    }
+
+    // Chama fn(chave, valor) para cada elemento, em ordem (a mesma da lista impressa)
+    template <typename F>
+    void for_each(F fn) const
+    {
+        _for_each(root, fn);
+    }
+
+    // Função que retorna as k chaves de maior valor, da maior para a menor
+    // Percorre a árvore inteira: como os contadores alterados por operator[] só são reposicionados
+    // no acesso seguinte, o heap pode estar temporariamente fora de ordem
+    std::vector<std::pair<T, Value>> top_k(size_t k) const
+    {
+        TopK<T, Value, COMPARATOR> top(k, compare);
+        std::vector<TreapNode<T, Value> *> stack;
+        if (root != nullptr)
+            stack.push_back(root);
+        while (!stack.empty())
+        {
+            TreapNode<T, Value> *node = stack.back();
+            stack.pop_back();
+            top.offer(node->key.first, node->key.second);
+            if (node->left != nullptr)
+                stack.push_back(node->left);
+            if (node->right != nullptr)
+                stack.push_back(node->right);
+        }
+        return top.result();
+    }
+
+    // Função para limpar a árvore
+    void clear()
+    {
+        _clear(root);
+
+        root = nullptr;
+        _size = 0;
+    }
+
+    // Função que verifica se a árvore contém uma chave
+    bool contains(const T &key)
+    {
+        stats.lookup();
+        return *descend(key) != nullptr;
+    }
+
+    // Função para retornar o número de comparações feitas
+    size_t comparisons()
+    {
+        return stats.comparisons();
+    }
+
+    // Função que retorna as estatísticas da árvore (contadores e altura atual)
+    EngineStats statistics() const
+    {
+        EngineStats s = stats.counters();
+        s.layout = EngineLayout::Tree;
+        s.height = tree_height(root);
+        s.size = _size;
+        return s;
+    }
+
+    // Função que retorna a memória ocupada pelos nós (estrutura, chaves e valores)
+    MemoryUsage memory() const
+    {
+        return mem.usage(_size, sizeof(T), sizeof(Value));
+    }
+
+    // Função para retornar o número de elementos na árvore
+    size_t size() const
+    {
+        return _size;
+    }
+};
+
+#endif
@@ -0,0 +1,376 @@
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#include "KeyArena.h"
+#include "LatencyHistogram.h"
+
+// Distribuição das chaves de uma carga sintética
+enum class KeyDistribution
+{
+    Uniform,   // Todas as palavras com a mesma probabilidade
+    Zipf,      // Frequência da palavra de posição r proporcional a 1 / r^skew (como nos textos reais)
+    Sorted,    // Palavras em ordem crescente (pior caso de rotações das árvores)
+    Reverse,   // Palavras em ordem decrescente
+    Collisions // Palavras com o mesmo hash (pior caso das tabelas de hash)
+};
+
+// Tipo de operação de uma carga sintética
+enum class OpType
+{
+    Add,    // Soma 1 à frequência (insere a palavra se necessário)
+    Find,   // Consulta a frequência
+    Remove, // Diminui a frequência em 1 (remove a palavra ao chegar a 0)
+    Update  // Define a frequência de uma palavra existente
+};
+
+// Operação sobre a palavra words()[key]
+struct Operation
+{
+    OpType type;
+    uint32_t key;
+    uint32_t value; // Nova frequência (Update)
+};
+
+// Configuração de uma carga sintética
+struct WorkloadConfig
+{
+    KeyDistribution distribution = KeyDistribution::Zipf;
+    size_t vocabulary = 100000;  // Número de palavras distintas disponíveis
+    size_t operations = 1000000; // Número de operações
+    double skew = 1.0;           // Expoente da distribuição de Zipf
+    double add = 1.0;            // Proporções das operações (não precisam somar 1)
+    double find = 0.0;
+    double remove = 0.0;
+    double update = 0.0;
+    uint32_t seed = 42; // Semente (a mesma configuração gera sempre a mesma carga)
+};
+
+// Resultado da execução de uma carga
+struct WorkloadCounts
+{
+    size_t adds = 0;
+    size_t finds = 0;
+    size_t hits = 0; // Consultas que encontraram a palavra
+    size_t removes = 0;
+    size_t updates = 0;
+    size_t skipped = 0; // Remoções e atualizações ignoradas (dicionário sem remove e update, como ApproxDict)
+};
+
+// Verifica se o dicionário D tem remove e update (ApproxDict só tem as operações de soma e leitura)
+template <typename D, typename = void>
+struct has_remove : std::false_type
+{
+};
+
+template <typename D>
+struct has_remove<D, std::void_t<decltype(std::declval<D &>().remove(std::declval<const std::string &>())),
+                                 decltype(std::declval<D &>().update(std::declval<const std::string &>(), 1))>> : std::true_type
+{
+};
+
+// Carga sintética: vocabulário e sequência de operações
+// A geração simula as operações em um modelo (frequência de cada palavra), então as remoções só
+// escolhem palavras presentes e a frequência final esperada de cada palavra é conhecida; verify()
+// confere um dicionário contra esse modelo depois de run()
+class Workload
+{
+private:
+    std::string m_name;               // Nome da carga (para relatórios)
+    std::vector<std::string> m_words; // Vocabulário (UTF-8)
+    std::vector<Operation> m_ops;     // Operações
+    std::vector<uint32_t> m_expected; // Frequência de cada palavra depois de todas as operações
+
+    // Palavra de índice i com largura fixa (ordem dos índices = ordem alfabética das palavras)
+    static std::string word_of(size_t i, size_t width)
+    {
+        std::string w(width, 'a');
+        for (size_t p = width; p-- > 0; i /= 26)
+            w[p] = static_cast<char>('a' + i % 26);
+        return w;
+    }
+
+    // Gera count palavras distintas com o mesmo WordRef::hash (o hash das tabelas de hash; a tabela
+    // da KeyArena usa outro hash, com semente, então a internação dessas palavras não degrada)
+    // Procura, pelo paradoxo do aniversário, dois blocos de letras que levam o hash ao mesmo estado;
+    // como o estado depois deles é igual, concatenar k pares de blocos dá 2^k palavras com o mesmo hash
+    static std::vector<std::string> colliding_words(size_t count, std::mt19937 &rng)
+    {
+        std::vector<std::pair<std::string, std::string>> blocks;
+        uint32_t state = WordRef::hash_of(""); // Estado inicial
+        while ((size_t(1) << blocks.size()) < count)
+        {
+            std::unordered_map<uint32_t, std::string> seen;
+            while (true)
+            {
+                std::string block(6, 'a');
+                for (char &c : block)
+                    c = static_cast<char>('a' + rng() % 26);
+                uint32_t h = WordRef::hash_of(block, state);
+                auto it = seen.find(h);
+                if (it == seen.end())
+                {
+                    seen.emplace(h, block);
+                    continue;
+                }
+                if (it->second == block)
+                    continue;
+                blocks.push_back({it->second, block});
+                state = h;
+                break;
+            }
+        }
+
+        std::vector<std::string> words(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            for (size_t b = 0; b < blocks.size(); b++)
+                words[i] += ((i >> b) & 1) ? blocks[b].second : blocks[b].first;
+        }
+        return words;
+    }
+
+public:
+    // Gera uma carga a partir da configuração
+    static Workload generate(const WorkloadConfig &config)
+    {
+        Workload w;
+        std::mt19937 rng(config.seed);
+        size_t n = std::max<size_t>(1, config.vocabulary);
+
+        // Vocabulário
+        if (config.distribution == KeyDistribution::Collisions)
+            w.m_words = colliding_words(n, rng);
+        else
+        {
+            size_t width = 1;
+            for (size_t cap = 26; cap < n; cap *= 26)
+                width++;
+            w.m_words.reserve(n);
+            for (size_t i = 0; i < n; i++)
+                w.m_words.push_back(word_of(i, width));
+        }
+
+        // Distribuição acumulada de Zipf, com as posições atribuídas às palavras em ordem aleatória
+        std::vector<double> cdf;
+        std::vector<uint32_t> rank;
+        if (config.distribution == KeyDistribution::Zipf)
+        {
+            cdf.resize(n);
+            double sum = 0;
+            for (size_t r = 0; r < n; r++)
+            {
+                sum += 1.0 / std::pow(static_cast<double>(r + 1), config.skew);
+                cdf[r] = sum;
+            }
+            for (double &c : cdf)
+                c /= sum;
+            rank.resize(n);
+            for (size_t i = 0; i < n; i++)
+                rank[i] = static_cast<uint32_t>(i);
+            std::shuffle(rank.begin(), rank.end(), rng);
+        }
+
+        std::uniform_real_distribution<double> unit(0.0, 1.0);
+        size_t cursor = 0; // Posição nas cargas ordenadas
+        auto next_key = [&]() -> uint32_t
+        {
+            switch (config.distribution)
+            {
+            case KeyDistribution::Zipf:
+            {
+                size_t r = std::lower_bound(cdf.begin(), cdf.end(), unit(rng)) - cdf.begin();
+                return rank[std::min(r, n - 1)];
+            }
+            case KeyDistribution::Sorted:
+                return static_cast<uint32_t>(cursor++ % n);
+            case KeyDistribution::Reverse:
+                return static_cast<uint32_t>(n - 1 - cursor++ % n);
+            default:
+                return static_cast<uint32_t>(rng() % n);
+            }
+        };
+
+        // Operações, simuladas no modelo
+        double add = config.add;
+        double total = config.add + config.find + config.remove + config.update;
+        if (total <= 0)
+            total = add = 1.0;
+        std::vector<uint32_t> &model = w.m_expected;
+        model.assign(n, 0);
+        w.m_ops.reserve(config.operations);
+        for (size_t i = 0; i < config.operations; i++)
+        {
+            double pick = unit(rng) * total;
+            uint32_t key = next_key();
+            Operation op{OpType::Add, key, 0};
+            if (pick < add)
+                op.type = OpType::Add;
+            else if (pick < add + config.find)
+                op.type = OpType::Find;
+            else if (pick < add + config.find + config.remove)
+                op.type = OpType::Remove;
+            else
+                op.type = OpType::Update;
+
+            // Remoções e atualizações só fazem sentido em palavras presentes: tenta mais algumas chaves
+            if (op.type == OpType::Remove || op.type == OpType::Update)
+            {
+                for (int attempt = 0; attempt < 8 && model[op.key] == 0; attempt++)
+                    op.key = next_key();
+                if (model[op.key] == 0)
+                    op.type = OpType::Find;
+            }
+
+            if (op.type == OpType::Add)
+                model[op.key]++;
+            else if (op.type == OpType::Remove)
+                model[op.key]--;
+            else if (op.type == OpType::Update)
+            {
+                op.value = 1 + rng() % 100;
+                model[op.key] = op.value;
+            }
+            w.m_ops.push_back(op);
+        }
+
+        static const char *names[] = {"uniforme", "zipf", "ordenada", "reversa", "colisoes"};
+        w.m_name = std::string(names[static_cast<int>(config.distribution)]);
+        if (config.distribution == KeyDistribution::Zipf)
+            w.m_name += "-" + std::to_string(config.skew).substr(0, 4);
+        if (config.find + config.remove + config.update > 0)
+            w.m_name += "-misto";
+        return w;
+    }
+
+    // Cria uma carga só de inserções a partir de um texto já tokenizado
+    static Workload from_tokens(const std::string &name, const std::vector<std::string> &tokens)
+    {
+        Workload w;
+        w.m_name = name;
+        std::unordered_map<std::string, uint32_t> index;
+        w.m_ops.reserve(tokens.size());
+        for (const std::string &token : tokens)
+        {
+            auto it = index.find(token);
+            if (it == index.end())
+            {
+                it = index.emplace(token, static_cast<uint32_t>(w.m_words.size())).first;
+                w.m_words.push_back(token);
+                w.m_expected.push_back(0);
+            }
+            w.m_ops.push_back({OpType::Add, it->second, 0});
+            w.m_expected[it->second]++;
+        }
+        return w;
+    }
+
+    // Executa as operações em um dicionário (API de Dict: add, find, remove, update)
+    // Com latency, a latência de cada operação (ou de uma amostra delas) vai para o histograma do tipo dela
+    template <typename D>
+    WorkloadCounts run(D &dict, LatencyRecorder *latency = nullptr) const
+    {
+        WorkloadCounts counts;
+        for (const Operation &op : m_ops)
+        {
+            const std::string &word = m_words[op.key];
+            switch (op.type)
+            {
+            case OpType::Add:
+            {
+                ScopedLatency timer(latency, LatencyOp::Add);
+                dict.add(word);
+                counts.adds++;
+                break;
+            }
+            case OpType::Find:
+            {
+                ScopedLatency timer(latency, LatencyOp::Find);
+                if (dict.find(word) > 0)
+                    counts.hits++;
+                counts.finds++;
+                break;
+            }
+            case OpType::Remove:
+                if constexpr (has_remove<D>::value)
+                {
+                    ScopedLatency timer(latency, LatencyOp::Remove);
+                    dict.remove(word);
+                    counts.removes++;
+                }
+                else
+                    counts.skipped++;
+                break;
+            case OpType::Update:
+                if constexpr (has_remove<D>::value)
+                {
+                    ScopedLatency timer(latency, LatencyOp::Update);
+                    dict.update(word, op.value);
+                    counts.updates++;
+                }
+                else
+                    counts.skipped++;
+                break;
+            }
+        }
+        return counts;
+    }
+
+    // Confere as frequências e o tamanho do dicionário contra o modelo; retorna o número de divergências
+    template <typename D>
+    size_t verify(D &dict, std::ostream &log = std::cerr) const
+    {
+        size_t errors = 0;
+        size_t distinct = 0;
+        for (size_t i = 0; i < m_words.size(); i++)
+        {
+            if (m_expected[i] > 0)
+                distinct++;
+            long long found = dict.find(m_words[i]);
+            bool present = dict.contains(m_words[i]);
+            if (found != m_expected[i] || present != (m_expected[i] > 0))
+            {
+                if (errors++ < 10)
+                    log << "verify: " << m_words[i] << " esperado " << m_expected[i] << ", encontrado " << found
+                        << (present ? " (presente)" : " (ausente)") << std::endl;
+            }
+        }
+        if (dict.size() != distinct)
+        {
+            log << "verify: tamanho esperado " << distinct << ", encontrado " << dict.size() << std::endl;
+            errors++;
+        }
+        return errors;
+    }
+
+    const std::string &name() const
+    {
+        return m_name;
+    }
+
+    const std::vector<std::string> &words() const
+    {
+        return m_words;
+    }
+
+    const std::vector<Operation> &operations() const
+    {
+        return m_ops;
+    }
+
+    size_t size() const
+    {
+        return m_ops.size();
+    }
+};
+
+#endif
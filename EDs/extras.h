@@ -3,10 +3,14 @@
 
 #include <iostream>
 #include <string>
+#include <string_view>
+#include <cstdint>
 #include <unicode/unistr.h>
 #include <unicode/ustream.h>
 #include <unicode/ucnv.h>
 #include <unicode/coll.h>
+#include "Hash64.h"
+#include "KeyArena.h"
 
 // Template de uma estrutura de comparador genérico
 template <typename T>
@@ -51,6 +55,31 @@ struct u_comparator
         UErrorCode status = U_ZERO_ERROR;
         return collator->compare(a, b, status) < 0;
     }
+
+    // Operador de comparação para palavras internadas, comparando os bytes UTF-8 direto da arena
+    bool operator()(const WordRef &a, const WordRef &b) const
+    {
+        if (a == b)
+            return false;
+        UErrorCode status = U_ZERO_ERROR;
+        return collator->compareUTF8(icu::StringPiece(a.data(), a.length()),
+                                     icu::StringPiece(b.data(), b.length()), status) < 0;
+    }
+
+    // Operador de comparação para texto UTF-8
+    bool operator()(const std::string &a, const std::string &b) const
+    {
+        UErrorCode status = U_ZERO_ERROR;
+        return collator->compareUTF8(icu::StringPiece(a.data(), a.size()),
+                                     icu::StringPiece(b.data(), b.size()), status) < 0;
+    }
+
+    bool operator()(std::string_view a, std::string_view b) const
+    {
+        UErrorCode status = U_ZERO_ERROR;
+        return collator->compareUTF8(icu::StringPiece(a.data(), static_cast<int32_t>(a.size())),
+                                     icu::StringPiece(b.data(), static_cast<int32_t>(b.size())), status) < 0;
+    }
 };
 
 #endif
@@ -0,0 +1,551 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#ifdef __linux__
+#include <sys/resource.h>
+#endif
+#include "./EDs/Dict.h"
+#include "./EDs/ApproxDict.h"
+#include "./EDs/Workload.h"
+#include "./EDs/PerfCounters.h"
+#include "./functions.cpp"
+
+using namespace std;
+using namespace std::chrono;
+
+// Benchmark das estruturas: cada estrutura executa cada carga (as palavras dos livros de ./Textos
+// e cargas sintéticas de Workload.h, que podem misturar consultas, remoções e atualizações), com
+// execuções de aquecimento e repetições medidas. Imprime uma tabela com mediana e p95 dos tempos,
+// vazão (operações/s), comparações e pico de memória, e grava os mesmos dados em JSON para
+// comparar execuções de builds diferentes
+
+// Opções do benchmark
+struct BenchOptions
+{
+    int warmup = 1;                                  // --warmup=N: execuções descartadas antes das medidas
+    int reps = 5;                                    // --reps=N: execuções medidas
+    string json = "./output/benchmark.json";         // --json=CAMINHO: arquivo de saída em JSON
+    vector<int> engines = {1, 2, 3, 4, 5, 6, 7, 8};  // --engines=1,3,...: estruturas (mesmos números do main)
+    size_t synthetic = 1000000;                      // --synthetic=N: operações de cada carga sintética (0 desliga)
+    size_t vocabulary = 50000;                       // --vocab=N: palavras distintas das cargas sintéticas
+    vector<WorkloadConfig> workloads;                // --workload=zipf:1.1,uniform,...: cargas sintéticas (padrão: zipf:1.0)
+    WorkloadConfig mix;                              // --mix=add:70,find:20,remove:5,update:5: proporções das operações
+    bool verify = false;                             // --verify: confere as estruturas exatas contra o modelo da carga
+    bool perf = false;                               // --perf: contadores de hardware (ciclos, instruções, misses) por operação
+    const PerfCounters *counters = nullptr;          // Contadores abertos pelo main com --perf (nulo se indisponíveis)
+    uint32_t latency = 0;                            // --latency[=N]: percentis de latência por operação, 1 em N medida (0 desliga)
+    vector<string> files;                            // Arquivos de ./Textos (todos, se nenhum for dado)
+};
+
+// Resultado de uma estrutura em uma carga
+struct BenchResult
+{
+    string engine;
+    string corpus;
+    size_t operations = 0;
+    size_t distinct = 0;
+    size_t comparisons = 0;
+    vector<double> ms;       // Tempo de cada repetição
+    long peak_rss_kb = -1;   // Pico de memória residente do processo durante as repetições
+    long rss_growth_kb = -1; // Quanto o pico passou da memória residente antes das repetições (custo da estrutura)
+    long errors = -1;        // Divergências de --verify (-1 se não foi conferida)
+    long memory_bytes = -1;  // Memória medida pelo alocador da estrutura no fim da última repetição (-1 se não informada)
+    PerfValues counters;     // Contadores de hardware somados nas repetições medidas (--perf)
+    LatencyRecorder latency; // Latência de cada operação, medida em uma execução a mais (--latency)
+};
+
+// Reinicia o pico de memória residente do processo (VmHWM); retorna false se não for suportado
+bool ResetPeakRSS()
+{
+#ifdef __linux__
+    ofstream clear("/proc/self/clear_refs");
+    clear << "5";
+    clear.close();
+    return static_cast<bool>(clear);
+#else
+    return false;
+#endif
+}
+
+// Lê um campo de /proc/self/status, em KB (-1 se não for suportado)
+long ProcStatusKB(const string &field)
+{
+#ifdef __linux__
+    ifstream status("/proc/self/status");
+    string line;
+    while (getline(status, line))
+    {
+        if (line.rfind(field, 0) == 0)
+            return stol(line.substr(field.size()));
+    }
+#endif
+    return -1;
+}
+
+// Pico de memória residente do processo, em KB (-1 se não for suportado)
+long PeakRSS()
+{
+    long kb = ProcStatusKB("VmHWM:");
+#ifdef __linux__
+    struct rusage usage;
+    if (kb < 0 && getrusage(RUSAGE_SELF, &usage) == 0)
+        kb = usage.ru_maxrss;
+#endif
+    return kb;
+}
+
+// Memória residente atual do processo, em KB (-1 se não for suportado)
+long CurrentRSS()
+{
+    return ProcStatusKB("VmRSS:");
+}
+
+// Percentil p (0 a 100) pelo método do posto mais próximo
+double Percentile(vector<double> values, double p)
+{
+    if (values.empty())
+        return 0;
+    sort(values.begin(), values.end());
+    size_t rank = static_cast<size_t>(ceil(p / 100 * values.size()));
+    return values[rank == 0 ? 0 : rank - 1];
+}
+
+// Lê e tokeniza um arquivo de ./Textos (a leitura e a normalização não entram na medida)
+Workload LoadCorpus(const string &filename)
+{
+    stringstream file = LoadFile("./Textos/" + filename);
+    vector<string> tokens;
+    string word;
+    while (file >> word)
+        tokens.push_back(word);
+    return Workload::from_tokens(filename, tokens);
+}
+
+// Mede uma estrutura em uma carga
+template <typename D>
+BenchResult Bench(const Workload &workload, const BenchOptions &opts)
+{
+    BenchResult result;
+    result.corpus = workload.name();
+    result.operations = workload.size();
+
+    for (int i = 0; i < opts.warmup; i++)
+    {
+        auto dict = make_unique<D>();
+        workload.run(*dict);
+    }
+
+    bool rss = ResetPeakRSS();
+    long base = CurrentRSS();
+    for (int i = 0; i < opts.reps; i++)
+    {
+        auto dict = make_unique<D>();
+        PerfValues before;
+        if (opts.counters != nullptr)
+            before = opts.counters->read();
+        auto start = steady_clock::now();
+        workload.run(*dict);
+        auto stop = steady_clock::now();
+        if (opts.counters != nullptr)
+            result.counters += opts.counters->read() - before;
+        result.ms.push_back(duration<double, milli>(stop - start).count());
+        result.comparisons = dict->comparisons();
+        result.distinct = dict->size();
+        if (i == opts.reps - 1)
+        {
+            result.engine = TypeName(typeid(*dict).name());
+            // ApproxDict só estima as frequências, então não é conferido
+            if (opts.verify && has_remove<D>::value)
+                result.errors = static_cast<long>(workload.verify(*dict));
+            if constexpr (has_memory<D>::value)
+                result.memory_bytes = static_cast<long>(dict->memory().total());
+        }
+    }
+    if (rss)
+    {
+        result.peak_rss_kb = PeakRSS();
+        if (base >= 0 && result.peak_rss_kb >= 0)
+            result.rss_growth_kb = result.peak_rss_kb - base;
+    }
+
+    // A latência por operação lê o relógio em volta de cada operação, então é medida em uma execução
+    // separada, fora das repetições cronometradas
+    if (opts.latency > 0)
+    {
+        result.latency = LatencyRecorder(opts.latency);
+        auto dict = make_unique<D>();
+        workload.run(*dict, &result.latency);
+    }
+    return result;
+}
+
+// Mede a estrutura de número mode (mesma numeração do main); retorna false se o número for inválido
+bool BenchEngine(int mode, const Workload &workload, const BenchOptions &opts, BenchResult &result)
+{
+    if (mode == 1)
+        result = Bench<Dict<AVLTree<WordRef, int, u_comparator>>>(workload, opts);
+    else if (mode == 2)
+        result = Bench<Dict<RBTree<WordRef, int, u_comparator>>>(workload, opts);
+    else if (mode == 3)
+        result = Bench<Dict<Hash2Table<WordRef, int, u_comparator>>>(workload, opts);
+    else if (mode == 4)
+        result = Bench<Dict<HashTable<WordRef, int, u_comparator>>>(workload, opts);
+    else if (mode == 5)
+        result = Bench<Dict<Treap<WordRef, int, u_comparator>>>(workload, opts);
+    else if (mode == 6)
+        result = Bench<Dict<SkipList<WordRef, int, u_comparator>>>(workload, opts);
+    else if (mode == 7)
+        result = Bench<Dict<PersistentAVLTree<WordRef, int, u_comparator>>>(workload, opts);
+    else if (mode == 8)
+        result = Bench<ApproxDict<u_comparator>>(workload, opts);
+    else
+        return false;
+    return true;
+}
+
+// Escreve uma string JSON (com escape de aspas, barras e caracteres de controle)
+void WriteJSONString(ostream &os, const string &s)
+{
+    os << '"';
+    for (char c : s)
+    {
+        if (c == '"' || c == '\\')
+            os << '\\' << c;
+        else if (static_cast<unsigned char>(c) < 0x20)
+            os << "\\u00" << "0123456789abcdef"[(c >> 4) & 0xf] << "0123456789abcdef"[c & 0xf];
+        else
+            os << c;
+    }
+    os << '"';
+}
+
+// Grava os resultados em JSON
+void WriteJSON(const string &path, const BenchOptions &opts, const vector<BenchResult> &results)
+{
+    ofstream os(path);
+    os << "{\n  \"warmup\": " << opts.warmup << ",\n  \"reps\": " << opts.reps << ",\n  \"results\": [";
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const BenchResult &r = results[i];
+        double median = Percentile(r.ms, 50);
+        os << (i ? "," : "") << "\n    {\"engine\": ";
+        WriteJSONString(os, r.engine);
+        os << ", \"corpus\": ";
+        WriteJSONString(os, r.corpus);
+        os << ", \"operations\": " << r.operations << ", \"distinct\": " << r.distinct
+           << ", \"comparisons\": " << r.comparisons
+           << ", \"median_ms\": " << median << ", \"p95_ms\": " << Percentile(r.ms, 95)
+           << ", \"ops_per_s\": " << (median > 0 ? llround(r.operations / (median / 1000)) : 0)
+           << ", \"peak_rss_kb\": " << r.peak_rss_kb << ", \"rss_growth_kb\": " << r.rss_growth_kb
+           << ", \"memory_bytes\": " << r.memory_bytes
+           << ", \"bytes_per_key\": " << (r.memory_bytes >= 0 && r.distinct > 0 ? static_cast<double>(r.memory_bytes) / r.distinct : -1.0);
+        if (r.errors >= 0)
+            os << ", \"errors\": " << r.errors;
+        if (opts.counters != nullptr)
+        {
+            os << ", \"counters\": ";
+            r.counters.write_json(os);
+        }
+        if (opts.latency > 0)
+        {
+            os << ", \"latency_ns\": ";
+            r.latency.write_json(os);
+        }
+        os << ", \"times_ms\": [";
+        for (size_t j = 0; j < r.ms.size(); j++)
+            os << (j ? ", " : "") << r.ms[j];
+        os << "]}";
+    }
+    os << "\n  ]\n}\n";
+}
+
+// Imprime os contadores de hardware de um resultado, por operação (média das repetições)
+void PrintCounters(const BenchResult &r)
+{
+    double ops = static_cast<double>(r.operations) * r.ms.size();
+    if (ops == 0)
+        return;
+    printf("  por operação:");
+    for (int e = 0; e < static_cast<int>(PerfEvent::Count); e++)
+    {
+        PerfEvent event = static_cast<PerfEvent>(e);
+        if (r.counters.has(event))
+            printf(" %s %.2f,", PerfValues::name(event), r.counters[event] / ops);
+    }
+    if (r.counters.has(PerfEvent::Cycles) && r.counters.has(PerfEvent::Instructions) && r.counters[PerfEvent::Cycles] > 0)
+        printf(" IPC %.2f", static_cast<double>(r.counters[PerfEvent::Instructions]) / r.counters[PerfEvent::Cycles]);
+    printf("\n");
+}
+
+// Imprime os percentis de latência de cada operação de um resultado, em ns (--latency)
+void PrintLatency(const BenchResult &r)
+{
+    for (int o = 0; o < static_cast<int>(LatencyOp::Count); o++)
+    {
+        LatencyOp op = static_cast<LatencyOp>(o);
+        const LatencyHistogram &h = r.latency[op];
+        if (h.total() == 0)
+            continue;
+        printf("  latência %-6s (ns): p50 %llu, p90 %llu, p99 %llu, p99.9 %llu, max %llu (%llu amostras)\n",
+               LatencyRecorder::name(op), (unsigned long long)h.percentile(50), (unsigned long long)h.percentile(90),
+               (unsigned long long)h.percentile(99), (unsigned long long)h.percentile(99.9), (unsigned long long)h.max(),
+               (unsigned long long)h.total());
+    }
+}
+
+// Lê um número inteiro de uma opção --nome=N
+bool ParseNumber(const string &arg, size_t prefix, long long &value)
+{
+    try
+    {
+        size_t pos;
+        value = stoll(arg.substr(prefix), &pos);
+        return pos == arg.size() - prefix && value >= 0;
+    }
+    catch (exception &e)
+    {
+        return false;
+    }
+}
+
+// Lê uma lista de cargas sintéticas (--workload=zipf:1.1,uniform,sorted,reverse,collisions)
+bool ParseWorkloads(const string &list, vector<WorkloadConfig> &workloads)
+{
+    stringstream items(list);
+    string item;
+    while (getline(items, item, ','))
+    {
+        WorkloadConfig config;
+        string name = item.substr(0, item.find(':'));
+        if (name == "zipf")
+        {
+            config.distribution = KeyDistribution::Zipf;
+            if (item.size() > name.size())
+            {
+                try
+                {
+                    size_t pos;
+                    config.skew = stod(item.substr(name.size() + 1), &pos);
+                    if (pos != item.size() - name.size() - 1 || config.skew <= 0)
+                        return false;
+                }
+                catch (exception &e)
+                {
+                    return false;
+                }
+            }
+        }
+        else if (item == "uniform")
+            config.distribution = KeyDistribution::Uniform;
+        else if (item == "sorted")
+            config.distribution = KeyDistribution::Sorted;
+        else if (item == "reverse")
+            config.distribution = KeyDistribution::Reverse;
+        else if (item == "collisions")
+            config.distribution = KeyDistribution::Collisions;
+        else
+            return false;
+        workloads.push_back(config);
+    }
+    return !workloads.empty();
+}
+
+// Lê as proporções das operações (--mix=add:70,find:20,remove:5,update:5; as ausentes ficam em 0)
+bool ParseMix(const string &list, WorkloadConfig &mix)
+{
+    mix.add = mix.find = mix.remove = mix.update = 0;
+    stringstream items(list);
+    string item;
+    while (getline(items, item, ','))
+    {
+        size_t sep = item.find(':');
+        long long value;
+        if (sep == string::npos || !ParseNumber(item, sep + 1, value))
+            return false;
+        string op = item.substr(0, sep);
+        if (op == "add")
+            mix.add = static_cast<double>(value);
+        else if (op == "find")
+            mix.find = static_cast<double>(value);
+        else if (op == "remove")
+            mix.remove = static_cast<double>(value);
+        else if (op == "update")
+            mix.update = static_cast<double>(value);
+        else
+            return false;
+    }
+    return mix.add + mix.find + mix.remove + mix.update > 0;
+}
+
+// Lê as opções da linha de comando; retorna false se alguma for inválida
+bool ParseBenchOptions(int argc, char *argv[], BenchOptions &opts)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        long long value;
+        if (arg.rfind("--warmup=", 0) == 0)
+        {
+            if (!ParseNumber(arg, 9, value))
+                return false;
+            opts.warmup = static_cast<int>(value);
+        }
+        else if (arg.rfind("--reps=", 0) == 0)
+        {
+            if (!ParseNumber(arg, 7, value) || value == 0)
+                return false;
+            opts.reps = static_cast<int>(value);
+        }
+        else if (arg.rfind("--synthetic=", 0) == 0)
+        {
+            if (!ParseNumber(arg, 12, value))
+                return false;
+            opts.synthetic = static_cast<size_t>(value);
+        }
+        else if (arg.rfind("--vocab=", 0) == 0)
+        {
+            if (!ParseNumber(arg, 8, value) || value == 0)
+                return false;
+            opts.vocabulary = static_cast<size_t>(value);
+        }
+        else if (arg.rfind("--workload=", 0) == 0)
+        {
+            opts.workloads.clear();
+            if (!ParseWorkloads(arg.substr(11), opts.workloads))
+                return false;
+        }
+        else if (arg.rfind("--mix=", 0) == 0)
+        {
+            if (!ParseMix(arg.substr(6), opts.mix))
+                return false;
+        }
+        else if (arg == "--verify")
+            opts.verify = true;
+        else if (arg == "--perf")
+            opts.perf = true;
+        else if (arg == "--latency")
+            opts.latency = 1;
+        else if (arg.rfind("--latency=", 0) == 0)
+        {
+            if (!ParseNumber(arg, 10, value) || value == 0 || value > UINT32_MAX)
+                return false;
+            opts.latency = static_cast<uint32_t>(value);
+        }
+        else if (arg.rfind("--json=", 0) == 0)
+            opts.json = arg.substr(7);
+        else if (arg.rfind("--engines=", 0) == 0)
+        {
+            opts.engines.clear();
+            stringstream list(arg.substr(10));
+            string item;
+            while (getline(list, item, ','))
+            {
+                if (!ParseNumber("=" + item, 1, value))
+                    return false;
+                opts.engines.push_back(static_cast<int>(value));
+            }
+        }
+        else if (arg.rfind("--", 0) == 0)
+            return false;
+        else
+            opts.files.push_back(arg);
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    namespace fs = std::filesystem;
+    BenchOptions opts;
+    if (!ParseBenchOptions(argc, argv, opts))
+    {
+        cerr << "Invalid Arguments, open Readme.txt" << endl;
+        return 1;
+    }
+
+    // Sem arquivos na linha de comando, usa todos os textos de ./Textos
+    if (opts.files.empty() && fs::exists("./Textos"))
+    {
+        for (const auto &entry : fs::directory_iterator("./Textos"))
+        {
+            if (entry.path().extension() == ".txt")
+                opts.files.push_back(entry.path().filename().string());
+        }
+        sort(opts.files.begin(), opts.files.end());
+    }
+
+    vector<Workload> workloads;
+    for (const string &file : opts.files)
+        workloads.push_back(LoadCorpus(file));
+    if (opts.workloads.empty())
+        opts.workloads.push_back(WorkloadConfig());
+    for (WorkloadConfig config : opts.workloads)
+    {
+        if (opts.synthetic == 0)
+            break;
+        config.operations = opts.synthetic;
+        config.vocabulary = opts.vocabulary;
+        config.add = opts.mix.add;
+        config.find = opts.mix.find;
+        config.remove = opts.mix.remove;
+        config.update = opts.mix.update;
+        workloads.push_back(Workload::generate(config));
+    }
+
+    // Contadores de hardware (--perf): abertos uma vez e lidos antes e depois de cada repetição
+    unique_ptr<PerfCounters> counters;
+    if (opts.perf)
+    {
+        counters.reset(new PerfCounters());
+        if (counters->available())
+            opts.counters = counters.get();
+        else
+            printf("Contadores de hardware: indisponíveis (%s)\n", counters->error().c_str());
+    }
+
+    vector<BenchResult> results;
+    printf("%-45s %-34s %10s %10s %10s %12s %12s %10s %8s\n", "Estrutura", "Corpus", "Mediana", "p95", "Ops/s",
+           "Comparações", "Distintas", "RSS+", "B/chave");
+    for (const Workload &workload : workloads)
+    {
+        for (int mode : opts.engines)
+        {
+            BenchResult r;
+            if (!BenchEngine(mode, workload, opts, r))
+            {
+                cerr << "Invalid engine " << mode << endl;
+                return 1;
+            }
+            double median = Percentile(r.ms, 50);
+            char perKey[32] = "-"; // Bytes por chave distinta ("-" se a estrutura não informa a memória)
+            if (r.memory_bytes >= 0 && r.distinct > 0)
+                snprintf(perKey, sizeof(perKey), "%.1f", static_cast<double>(r.memory_bytes) / r.distinct);
+            printf("%-45s %-34s %8.1fms %8.1fms %10.0f %12zu %12zu %8ldKB %8s\n", r.engine.c_str(), r.corpus.c_str(), median,
+                   Percentile(r.ms, 95), median > 0 ? r.operations / (median / 1000) : 0.0, r.comparisons, r.distinct, r.rss_growth_kb,
+                   perKey);
+            if (r.errors > 0)
+                printf("  verify: %ld divergências\n", r.errors);
+            if (opts.counters != nullptr)
+                PrintCounters(r);
+            if (opts.latency > 0)
+                PrintLatency(r);
+            fflush(stdout);
+            results.push_back(r);
+        }
+    }
+
+    fs::path json(opts.json);
+    if (json.has_parent_path())
+        fs::create_directories(json.parent_path());
+    WriteJSON(opts.json, opts, results);
+    cout << "JSON: " << opts.json << endl;
+    return 0;
+}
@@ -8,13 +8,25 @@
 #include <sstream>
 #include <string>
 
+#include "./EDs/PhaseTimer.h"
+
 using namespace std;
 using namespace icu;
 
 // Função que retorna o tipo da estrutura de dados
 string TypeName(string type)
 {
-    if (type.find("HashTable") != string::npos)
+    if (type.find("HyperLogLog") != string::npos)
+        return "HyperLogLog (estimativa)";
+    else if (type.find("ApproxDict") != string::npos)
+        return "Count-Min Sketch + Space-Saving (aproximado)";
+    else if (type.find("SpillDict") != string::npos)
+        return TypeName(type.substr(type.find("SpillDict") + 9)) + " (com spill em disco)";
+    else if (type.find("IdDict") != string::npos)
+        return TypeName(type.substr(type.find("IdDict") + 6)) + " (IDs densos)";
+    else if (type.find("PersistentAVLTree") != string::npos)
+        return "AVLTree Persistente";
+    else if (type.find("HashTable") != string::npos)
         return "HashTable Separate Chaining";
     else if (type.find("AVLTree") != string::npos)
         return "AVLTree";
@@ -22,10 +34,183 @@ string TypeName(string type)
         return "RBTree";
     else if (type.find("Hash2Table") != string::npos)
         return "HashTable Open Addressing";
+    else if (type.find("Treap") != string::npos)
+        return "Treap";
+    else if (type.find("SkipList") != string::npos)
+        return "SkipList (lock-free)";
     else
         return "Unknown";
 }
 
+// Opções adicionais da linha de comando (depois do modo e do nome do arquivo)
+struct Options
+{
+    bool ids = false; // --ids: mapeia palavras para IDs densos e grava a sequência de IDs do texto
+    size_t top = 0;   // --top=N: lista apenas as N palavras mais frequentes (0 lista todas em ordem alfabética)
+    unsigned int hll = 0; // --hll[=P]: estima o vocabulário com HyperLogLog de precisão P antes da inserção (0 desliga)
+    size_t spill = 0;     // --spill=MB: grava a estrutura em disco ao passar de MB megabytes e intercala no final (0 desliga)
+    bool timings = false; // --timings: mede o tempo de cada fase (leitura, decodificação, ..., impressão)
+    bool stats = false;   // --stats: imprime as estatísticas da estrutura (buscas, rotações, rehash, ...) e grava em JSON
+    bool count = true;    // --no-count: compila a estrutura sem contadores (política NoStats)
+    bool perf = false;    // --perf: contadores de hardware (ciclos, instruções, cache e branch misses) por fase
+    uint32_t latency = 0; // --latency[=N]: percentis da latência de cada inserção, medindo 1 em N (0 desliga)
+    bool save = false;    // --save[=CAMINHO]: grava a estrutura em um snapshot binário no fim (padrão: <saída>.snap)
+    std::string save_path;
+    std::string load;     // --load=CAMINHO: preenche a estrutura a partir de um snapshot, sem ler o texto
+    bool freeze = false;  // --freeze: cria a versão imutável (FrozenDict) depois da inserção; com --save, grava ela
+    std::string queries;  // --queries=ARQUIVO: busca as palavras de outro texto de ./Textos e mede a vazão das buscas
+    double bloom = 0;     // --bloom[=P]: filtro de Bloom com taxa de falso positivo P na frente das buscas (0 desliga)
+    bool parallel = false; // --parallel: com vários modos ("1,2,3,4"), preenche as estruturas ao mesmo tempo, uma por thread
+    bool reader = false;   // --reader: (modo 7) uma thread lê snapshots do dicionário durante a inserção
+
+    // Modo aproximado (Count-Min Sketch)
+    double eps = 1e-4;   // --eps=E: erro máximo das frequências, relativo ao total de palavras
+    double delta = 0.01; // --delta=D: probabilidade de o erro passar de eps * total
+    size_t heavy = 1000; // --heavy=N: número de palavras frequentes guardadas de forma exata
+};
+
+// Função que lê as opções adicionais da linha de comando; retorna false se alguma for inválida
+bool ParseOptions(int argc, char *argv[], Options &opts)
+{
+    for (int i = 3; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg == "--ids")
+            opts.ids = true;
+        else if (arg == "--timings")
+            opts.timings = true;
+        else if (arg == "--stats")
+            opts.stats = true;
+        else if (arg == "--no-count")
+            opts.count = false;
+        else if (arg == "--perf")
+            opts.perf = true;
+        else if (arg == "--latency")
+            opts.latency = 1;
+        else if (arg.rfind("--latency=", 0) == 0)
+        {
+            try
+            {
+                unsigned long every = std::stoul(arg.substr(10));
+                if (every == 0 || every > UINT32_MAX)
+                    return false;
+                opts.latency = static_cast<uint32_t>(every);
+            }
+            catch (std::exception &e)
+            {
+                return false;
+            }
+        }
+        else if (arg == "--freeze")
+            opts.freeze = true;
+        else if (arg == "--parallel")
+            opts.parallel = true;
+        else if (arg == "--reader")
+            opts.reader = true;
+        else if (arg == "--save")
+            opts.save = true;
+        else if (arg.rfind("--save=", 0) == 0 && arg.size() > 7)
+        {
+            opts.save = true;
+            opts.save_path = arg.substr(7);
+        }
+        else if (arg.rfind("--load=", 0) == 0 && arg.size() > 7)
+            opts.load = arg.substr(7);
+        else if (arg.rfind("--queries=", 0) == 0 && arg.size() > 10)
+            opts.queries = arg.substr(10);
+        else if (arg == "--bloom")
+            opts.bloom = 0.01;
+        else if (arg.rfind("--bloom=", 0) == 0)
+        {
+            try
+            {
+                opts.bloom = std::stod(arg.substr(8));
+            }
+            catch (std::exception &e)
+            {
+                return false;
+            }
+            if (!(opts.bloom > 0 && opts.bloom < 1))
+                return false;
+        }
+        else if (arg == "--hll")
+            opts.hll = 12;
+        else if (arg.rfind("--hll=", 0) == 0)
+        {
+            try
+            {
+                opts.hll = std::stoul(arg.substr(6));
+            }
+            catch (std::exception &e)
+            {
+                return false;
+            }
+            if (opts.hll < 4 || opts.hll > 18)
+                return false;
+        }
+        else if (arg.rfind("--spill=", 0) == 0)
+        {
+            try
+            {
+                opts.spill = std::stoul(arg.substr(8));
+            }
+            catch (std::exception &e)
+            {
+                return false;
+            }
+            if (opts.spill == 0)
+                return false;
+        }
+        else if (arg.rfind("--top=", 0) == 0)
+        {
+            try
+            {
+                opts.top = std::stoul(arg.substr(6));
+            }
+            catch (std::exception &e)
+            {
+                return false;
+            }
+            if (opts.top == 0)
+                return false;
+        }
+        else if (arg.rfind("--eps=", 0) == 0 || arg.rfind("--delta=", 0) == 0 || arg.rfind("--heavy=", 0) == 0)
+        {
+            string value = arg.substr(arg.find('=') + 1);
+            try
+            {
+                if (arg[2] == 'e')
+                    opts.eps = std::stod(value);
+                else if (arg[2] == 'd')
+                    opts.delta = std::stod(value);
+                else
+                    opts.heavy = std::stoul(value);
+            }
+            catch (std::exception &e)
+            {
+                return false;
+            }
+            // Limites que mantêm o sketch (e / eps por ln(1 / delta) contadores) e a tabela exata em
+            // algumas centenas de MB
+            if (!(opts.eps >= 1e-6 && opts.eps < 1) || !(opts.delta >= 1e-6 && opts.delta < 1) || opts.heavy > 10000000)
+                return false;
+        }
+        else
+            return false;
+    }
+    if (opts.spill > 0 && opts.ids)
+        return false; // Os IDs densos precisam de todo o vocabulário em memória
+    if (opts.hll > 0 && !opts.load.empty())
+        return false; // O snapshot já traz o vocabulário, não há texto para estimar
+    if (opts.reader && (opts.spill > 0 || opts.ids || !opts.load.empty()))
+        return false; // O leitor só consulta um Dict preenchido a partir do texto
+    if ((opts.save || !opts.load.empty() || opts.freeze) && (opts.spill > 0 || opts.ids))
+        return false; // Snapshots guardam apenas palavras e frequências de um Dict
+    if ((!opts.queries.empty() || opts.bloom > 0) && (opts.spill > 0 || opts.ids))
+        return false; // As buscas em lote e o filtro de Bloom são do Dict
+    return true;
+}
+
 // Função que normaliza um texto Unicode, convertendo para minúsculas e substituindo caracteres não alfabéticos por espaços
 void Normalize(UnicodeString &text)
 {
@@ -49,7 +234,8 @@ void Normalize(UnicodeString &text)
 }
 
 // Função que carrega o conteúdo de um arquivo e retorna como um stringstream após normalização
-stringstream LoadFile(const string &path)
+// Com timings, soma o tempo da leitura, da conversão de codificação e da normalização nas fases correspondentes
+stringstream LoadFile(const string &path, PhaseTimings *timings = nullptr)
 {
     ifstream file(path, ios::binary); // Abre o arquivo em modo binário
     if (!file.is_open())
@@ -59,13 +245,27 @@ stringstream LoadFile(const string &path)
     }
 
     // Carrega o conteúdo do arquivo em uma string
-    string fdata((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+    string fdata;
+    {
+        ScopedTimer timer(timings, Phase::Read);
+        fdata.assign(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+    }
 
     // Converte a string carregada para UnicodeString, normaliza e retorna como stringstream
-    UnicodeString udata = UnicodeString::fromUTF8(fdata); // Converte para UnicodeString
-    Normalize(udata);                                     // Normaliza o texto
+    UnicodeString udata;
+    {
+        ScopedTimer timer(timings, Phase::Decode);
+        udata = UnicodeString::fromUTF8(fdata); // Converte para UnicodeString
+    }
+    {
+        ScopedTimer timer(timings, Phase::Normalize);
+        Normalize(udata); // Normaliza o texto
+    }
 
     string normalizedText;
-    udata.toUTF8String(normalizedText);  // Converte de volta para string UTF-8
-    return stringstream(normalizedText); // Retorna um stringstream com o texto normalizado
+    {
+        ScopedTimer timer(timings, Phase::Decode);
+        udata.toUTF8String(normalizedText); // Converte de volta para string UTF-8
+    }
+    return stringstream(std::move(normalizedText)); // Retorna um stringstream com o texto normalizado
 }
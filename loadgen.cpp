@@ -0,0 +1,306 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#ifdef __linux__
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+#include "./EDs/LatencyHistogram.h"
+#include "./EDs/QueryProtocol.h"
+#include "./functions.cpp"
+
+using namespace std;
+using namespace std::chrono;
+
+// Gerador de carga do servidor de consultas (server.cpp): abre conexões ao socket, manda pedidos em
+// lotes de --pipeline pedidos seguidos (sem esperar as respostas) e mede o tempo de cada pedido, do
+// envio do lote até a chegada da sua resposta. Imprime a vazão (pedidos/s) e os percentis de latência
+
+// Opções do gerador de carga
+struct LoadOptions
+{
+    string socket = "./output/dict.sock"; // --socket=CAMINHO: socket do servidor
+    size_t requests = 100000;             // --requests=N: total de pedidos (divididos entre as conexões)
+    int connections = 1;                  // --connections=N: conexões simultâneas (uma thread cada)
+    size_t pipeline = 16;                 // --pipeline=N: pedidos enviados antes de ler as respostas
+    QueryOp op = QueryOp::Find;           // --op=find|contains|top:K|prefix[:LIMITE]: operação dos pedidos
+    uint32_t arg = 0;                     // Argumento da operação (k do top, limite do prefix)
+    double miss = 0;                      // --miss=P: porcentagem de palavras ausentes (find, contains)
+    string text;                          // --text=ARQUIVO: palavras consultadas (de ./Textos); sem ele, todo o vocabulário do servidor
+};
+
+// Resultado de uma conexão
+struct LoadResult
+{
+    LatencyHistogram latency;
+    size_t requests = 0;
+    size_t hits = 0;   // Respostas com n > 0 (palavra encontrada, entradas devolvidas)
+    size_t errors = 0; // Respostas com erro ou mal formadas
+    bool failed = false;
+};
+
+#ifdef __linux__
+// Conecta ao socket do servidor; retorna -1 em caso de erro
+int Connect(const string &path)
+{
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path))
+        return -1;
+    strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd >= 0 && connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0)
+    {
+        close(fd);
+        fd = -1;
+    }
+    return fd;
+}
+
+// Envia todo o buffer; enquanto o socket não aceita mais bytes, recebe as respostas que já chegaram
+// (sem isso, um lote grande trava: o servidor para de ler quando o cliente não lê as respostas)
+bool SendAll(int fd, const string &buf, FrameReader &in, vector<char> &buffer)
+{
+    size_t sent = 0;
+    while (sent < buf.size())
+    {
+        ssize_t n = send(fd, buf.data() + sent, buf.size() - sent, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (n > 0)
+        {
+            sent += static_cast<size_t>(n);
+            continue;
+        }
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK))
+            return false;
+        pollfd p = {fd, POLLIN | POLLOUT, 0};
+        if (poll(&p, 1, -1) < 0 && errno != EINTR)
+            return false;
+        if (p.revents & POLLIN)
+        {
+            ssize_t r = recv(fd, buffer.data(), buffer.size(), MSG_DONTWAIT);
+            if (r == 0)
+                return false;
+            if (r > 0)
+                in.feed(buffer.data(), static_cast<size_t>(r));
+        }
+    }
+    return true;
+}
+
+// Lê o próximo quadro de resposta (bloqueando); retorna false se a conexão fechou
+bool Receive(int fd, FrameReader &in, string_view &body, vector<char> &buffer)
+{
+    int status;
+    while ((status = in.next(body)) == 0)
+    {
+        in.compact();
+        ssize_t n = recv(fd, buffer.data(), buffer.size(), 0);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        in.feed(buffer.data(), static_cast<size_t>(n));
+    }
+    return status > 0;
+}
+
+// Busca todo o vocabulário do servidor (prefixo vazio, sem limite)
+bool FetchVocabulary(const LoadOptions &opts, vector<string> &words)
+{
+    int fd = Connect(opts.socket);
+    if (fd < 0)
+        return false;
+    string buf;
+    encode_request(buf, QueryOp::Prefix, 0, "");
+    FrameReader in;
+    vector<char> buffer(1 << 16);
+    string_view body;
+    QueryResponse res;
+    bool ok = SendAll(fd, buf, in, buffer) && Receive(fd, in, body, buffer) && decode_response(body, res);
+    close(fd);
+    for (auto &entry : res.entries)
+        words.push_back(std::move(entry.first));
+    return ok;
+}
+
+// Executa a parte da carga de uma conexão
+void RunConnection(const LoadOptions &opts, const vector<string> &words, size_t requests, unsigned seed, LoadResult &result)
+{
+    int fd = Connect(opts.socket);
+    if (fd < 0)
+    {
+        result.failed = true;
+        return;
+    }
+    mt19937_64 rng(seed);
+    uniform_int_distribution<size_t> pick(0, words.size() - 1);
+    uniform_real_distribution<double> chance(0, 100);
+    FrameReader in;
+    vector<char> buffer(1 << 16);
+    string out;
+    QueryResponse res;
+    string_view body;
+    while (result.requests < requests)
+    {
+        size_t batch = min(opts.pipeline, requests - result.requests);
+        out.clear();
+        for (size_t i = 0; i < batch; i++)
+        {
+            const string &word = words[pick(rng)];
+            if (opts.miss > 0 && chance(rng) < opts.miss)
+                encode_request(out, opts.op, opts.arg, word + "#"); // Nunca está no dicionário
+            else
+                encode_request(out, opts.op, opts.arg, word);
+        }
+        auto start = steady_clock::now();
+        if (!SendAll(fd, out, in, buffer))
+        {
+            result.failed = true;
+            break;
+        }
+        for (size_t i = 0; i < batch; i++)
+        {
+            if (!Receive(fd, in, body, buffer))
+            {
+                result.failed = true;
+                close(fd);
+                return;
+            }
+            result.latency.record(static_cast<uint64_t>(duration_cast<nanoseconds>(steady_clock::now() - start).count()));
+            if (!decode_response(body, res, false) || res.status != QueryStatus::Ok)
+                result.errors++;
+            else if (res.n > 0)
+                result.hits++;
+        }
+        result.requests += batch;
+    }
+    close(fd);
+}
+#endif
+
+// Lê as opções da linha de comando; retorna false se alguma for inválida
+bool ParseLoadOptions(int argc, char *argv[], LoadOptions &opts)
+{
+    try
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            string arg = argv[i];
+            if (arg.rfind("--socket=", 0) == 0 && arg.size() > 9)
+                opts.socket = arg.substr(9);
+            else if (arg.rfind("--requests=", 0) == 0)
+                opts.requests = stoul(arg.substr(11));
+            else if (arg.rfind("--connections=", 0) == 0)
+                opts.connections = stoi(arg.substr(14));
+            else if (arg.rfind("--pipeline=", 0) == 0)
+                opts.pipeline = stoul(arg.substr(11));
+            else if (arg.rfind("--miss=", 0) == 0)
+                opts.miss = stod(arg.substr(7));
+            else if (arg.rfind("--text=", 0) == 0 && arg.size() > 7)
+                opts.text = arg.substr(7);
+            else if (arg == "--op=find")
+                opts.op = QueryOp::Find;
+            else if (arg == "--op=contains")
+                opts.op = QueryOp::Contains;
+            else if (arg.rfind("--op=top:", 0) == 0)
+            {
+                opts.op = QueryOp::TopK;
+                opts.arg = static_cast<uint32_t>(stoul(arg.substr(9)));
+            }
+            else if (arg == "--op=prefix" || arg.rfind("--op=prefix:", 0) == 0)
+            {
+                opts.op = QueryOp::Prefix;
+                opts.arg = arg.size() > 11 ? static_cast<uint32_t>(stoul(arg.substr(12))) : 0;
+            }
+            else
+                return false;
+        }
+    }
+    catch (exception &e)
+    {
+        return false;
+    }
+    return opts.requests > 0 && opts.connections > 0 && opts.pipeline > 0 && opts.miss >= 0 && opts.miss <= 100;
+}
+
+int main(int argc, char *argv[])
+{
+    LoadOptions opts;
+    if (!ParseLoadOptions(argc, argv, opts))
+    {
+        cerr << "Invalid Arguments, open Readme.txt" << endl;
+        return 1;
+    }
+#ifdef __linux__
+    vector<string> words;
+    if (!opts.text.empty())
+    {
+        stringstream file = LoadFile("./Textos/" + opts.text);
+        string word;
+        while (file >> word)
+            words.push_back(word);
+    }
+    else if (!FetchVocabulary(opts, words))
+    {
+        cerr << "Error: Could not connect to " << opts.socket << endl;
+        return 1;
+    }
+    if (words.empty())
+    {
+        cerr << "Error: No words to query" << endl;
+        return 1;
+    }
+
+    vector<LoadResult> results(opts.connections);
+    vector<thread> threads;
+    auto start = steady_clock::now();
+    for (int t = 0; t < opts.connections; t++)
+    {
+        // Divide os pedidos entre as conexões (as primeiras ficam com o resto)
+        size_t share = opts.requests / opts.connections + (static_cast<size_t>(t) < opts.requests % opts.connections ? 1 : 0);
+        threads.emplace_back(RunConnection, cref(opts), cref(words), share, static_cast<unsigned>(t + 1), ref(results[t]));
+    }
+    for (auto &th : threads)
+        th.join();
+    double seconds = duration<double>(steady_clock::now() - start).count();
+
+    LatencyHistogram latency;
+    size_t requests = 0, hits = 0, errors = 0;
+    bool failed = false;
+    for (auto &r : results)
+    {
+        latency.merge(r.latency);
+        requests += r.requests;
+        hits += r.hits;
+        errors += r.errors;
+        failed = failed || r.failed;
+    }
+    printf("%zu pedidos em %.3fs: %.0f pedidos/s (%d conexões, %zu em pipeline)\n", requests, seconds,
+           seconds > 0 ? requests / seconds : 0.0, opts.connections, opts.pipeline);
+    printf("Latência (ns): média %.0f, p50 %llu, p90 %llu, p99 %llu, p99.9 %llu, max %llu\n", latency.mean(),
+           (unsigned long long)latency.percentile(50), (unsigned long long)latency.percentile(90),
+           (unsigned long long)latency.percentile(99), (unsigned long long)latency.percentile(99.9),
+           (unsigned long long)latency.max());
+    printf("Respostas com resultado: %zu, erros: %zu\n", hits, errors);
+    if (failed)
+    {
+        cerr << "Error: Connection to " << opts.socket << " failed" << endl;
+        return 1;
+    }
+    return errors > 0 ? 1 : 0;
+#else
+    cerr << "The load generator needs Linux (Unix sockets)" << endl;
+    return 1;
+#endif
+}
@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <iostream>
 #include <fstream>
@@ -5,6 +7,10 @@
 #include <string>
 #include <sstream>
 #include <variant>
+#include <thread>
+#include <memory>
+#include <mutex>
+#include <vector>
 #include <unicode/unistr.h>
 #include <unicode/ustream.h>
 #include <unicode/ucnv.h>
@@ -12,53 +18,784 @@
 #include <unicode/locid.h>
 #include <unicode/coll.h>
 #include "./EDs/Dict.h"
+#include "./EDs/IdDict.h"
+#include "./EDs/ApproxDict.h"
+#include "./EDs/HyperLogLog.h"
+#include "./EDs/SpillDict.h"
+#include "./EDs/LatencyHistogram.h"
+#include "./EDs/TokenBuffer.h"
 #include "./functions.cpp"
 
 using namespace std;
 using namespace std::chrono;
 using namespace icu;
 
+// função que imprime as linhas extras do cabeçalho de cada tipo de dicionário (nenhuma, por padrão)
+template <typename dicts>
+void report_extra(dicts &, OutputBuffer &)
+{
+}
+
+// dicionário aproximado: limite do erro das frequências e memória usada
+template <typename C>
+void report_extra(ApproxDict<C> &dict, OutputBuffer &out)
+{
+    out << "Erro estimado das frequências: +" << dict.error_bound() << " (eps = " << dict.epsilon()
+        << ", confiança = " << 1 - dict.delta() << ", total = " << dict.total() << ")" << '\n';
+    out << "Memória usada: " << dict.bytes() << " bytes" << '\n';
+}
+
+// dicionário com spill em disco: número de runs gravados
+template <typename EDType>
+void report_extra(SpillDict<EDType> &dict, OutputBuffer &out)
+{
+    out << "Runs gravados em disco: " << dict.runs() << '\n';
+}
+
+// função que imprime o tempo de cada fase no cabeçalho
+void report_timings(const PhaseTimings &timings, OutputBuffer &out)
+{
+    out << "Tempo por fase (ns): " << '\n';
+    for (int p = 0; p < static_cast<int>(Phase::Count); p++)
+        out << "  " << PhaseTimings::name(static_cast<Phase>(p)) << ": " << timings.ns(static_cast<Phase>(p)) << '\n';
+    out << "  Total: " << timings.total() << '\n';
+}
+
+// função que imprime as estatísticas da estrutura no cabeçalho (só nas estruturas que as expõem)
+template <typename dicts>
+void report_stats(const dicts &dict, OutputBuffer &out)
+{
+    if constexpr (has_statistics<dicts>::value)
+        dict.statistics().print(out);
+}
+
+// função que grava as estatísticas da estrutura em JSON ao lado da saída
+template <typename dicts>
+void save_stats(const dicts &dict, const std::string &path)
+{
+    if constexpr (has_statistics<dicts>::value)
+    {
+        std::ofstream json(path);
+        dict.statistics().write_json(json);
+    }
+}
+
+// função que imprime os contadores de hardware da inserção, no total e por palavra inserida
+void report_counters(const PhaseTimings &timings, OutputBuffer &out)
+{
+    const PerfCounters *perf = timings.perf();
+    if (!perf->available())
+    {
+        out << "Contadores de hardware: indisponíveis (" << perf->error() << ")" << '\n';
+        return;
+    }
+    const PerfValues &insert = timings.counters(Phase::Insert);
+    uint64_t tokens = timings.tokens();
+    out << "Contadores de hardware (inserção, " << tokens << " palavras): " << '\n';
+    for (int e = 0; e < static_cast<int>(PerfEvent::Count); e++)
+    {
+        PerfEvent event = static_cast<PerfEvent>(e);
+        out << "  " << PerfValues::name(event) << ": ";
+        if (!insert.has(event))
+        {
+            out << "indisponível" << '\n';
+            continue;
+        }
+        out << insert[event];
+        if (tokens > 0)
+            out << " (" << static_cast<double>(insert[event]) / tokens << " por palavra)";
+        out << '\n';
+    }
+    if (insert.has(PerfEvent::Cycles) && insert.has(PerfEvent::Instructions) && insert[PerfEvent::Cycles] > 0)
+        out << "  Instruções por ciclo: " << static_cast<double>(insert[PerfEvent::Instructions]) / insert[PerfEvent::Cycles] << '\n';
+}
+
+// função que imprime os percentis da latência das inserções no cabeçalho
+void report_latency(const LatencyRecorder &latency, OutputBuffer &out)
+{
+    out << "Latência por operação (ns";
+    if (latency.every() > 1)
+        out << ", 1 em " << latency.every() << " medida";
+    out << "): " << '\n';
+    latency.print(out);
+}
+
+// função que cria a versão imutável do dicionário (--freeze) e imprime a memória e o tempo dela
+// Com --save, o snapshot gravado é o da versão imutável (com a árvore de Eytzinger e o hash perfeito)
+template <typename dicts>
+void report_freeze(dicts &dict, const Options &opts, OutputBuffer &out)
+{
+    if constexpr (has_freeze<dicts>::value)
+    {
+        auto start = high_resolution_clock::now();
+        auto frozen = dict.freeze();
+        auto duration = duration_cast<milliseconds>(high_resolution_clock::now() - start);
+        MemoryUsage m = frozen.memory();
+        out << "Versão congelada: " << m.total() << " bytes (estrutura " << m.structure << ", chaves " << m.keys
+            << ", valores " << m.values << "), " << m.per_key(frozen.size()) << " bytes por palavra, criada em "
+            << duration.count() << "ms" << '\n';
+        if (opts.save && !frozen.save(opts.save_path))
+            cerr << "Error writing snapshot" << endl;
+    }
+}
+
+// função que liga o filtro de Bloom do dicionário (--bloom), dimensionado para expected palavras
+template <typename dicts>
+void enable_bloom(dicts &dict, const Options &opts, size_t expected = 0)
+{
+    if constexpr (has_bloom<dicts>::value)
+    {
+        if (opts.bloom > 0)
+            dict.bloom(opts.bloom, expected);
+    }
+}
+
+// função que imprime a memória e a taxa de falso positivo do filtro de Bloom no cabeçalho
+template <typename dicts>
+void report_bloom(const dicts &dict, OutputBuffer &out)
+{
+    if constexpr (has_bloom<dicts>::value)
+    {
+        const BloomFilter *bloom = dict.bloom_filter();
+        if (bloom == nullptr)
+            return;
+        out << "Filtro de Bloom: " << bloom->bytes() << " bytes para " << bloom->capacity() << " palavras ("
+            << bloom->bits_per_key() << " bits por palavra, k = " << bloom->hashes() << "), falso positivo estimado "
+            << 100 * bloom->false_positive_rate() << "% (alvo " << 100 * bloom->target() << "%)" << '\n';
+    }
+}
+
+// Resultado das leituras de snapshots feitas durante a inserção
+struct SnapshotReads
+{
+    size_t reads = 0;    // Snapshots lidos
+    size_t largest = 0;  // Palavras do maior snapshot lido
+    size_t invalid = 0;  // Snapshots inconsistentes (percurso diferente do tamanho, ou menores que um anterior)
+};
+
+// Leitor que consulta snapshots do dicionário em outra thread enquanto a inserção acontece (só nas
+// estruturas com snapshot): cada leitura percorre uma versão inteira, conferindo que o número de palavras
+// percorridas é o tamanho dela, e seleciona as 10 mais frequentes, como faria uma thread de consultas
+template <typename dicts>
+class SnapshotReader
+{
+private:
+    std::atomic<bool> m_stop{false};
+    SnapshotReads m_reads;
+    std::thread m_thread;
+
+public:
+    SnapshotReader(const dicts &dict)
+        : m_thread([this, &dict]()
+                   {
+            while (!m_stop.load(std::memory_order_acquire))
+            {
+                auto version = dict.snapshot();
+                size_t n = 0;
+                version.for_each([&n](const auto &, const auto &)
+                                 { n++; });
+                version.top_k(10);
+                if (n != version.size() || n < m_reads.largest)
+                    m_reads.invalid++;
+                m_reads.largest = std::max(m_reads.largest, n);
+                m_reads.reads++;
+                std::this_thread::sleep_for(std::chrono::milliseconds(1)); // Não disputa o processador com a inserção
+            } })
+    {
+    }
+
+    ~SnapshotReader()
+    {
+        if (m_thread.joinable())
+            stop();
+    }
+
+    // Para o leitor e retorna o resultado das leituras
+    SnapshotReads stop()
+    {
+        m_stop.store(true, std::memory_order_release);
+        m_thread.join();
+        return m_reads;
+    }
+};
+
+// função que imprime as leituras de snapshots feitas durante a inserção no cabeçalho
+void report_reads(const SnapshotReads &reads, OutputBuffer &out)
+{
+    out << "Snapshots lidos durante a inserção: " << reads.reads << " (o maior com " << reads.largest
+        << " palavras, " << reads.invalid << " inconsistentes)" << '\n';
+}
+
+// função que busca as palavras de outro texto (--queries) uma a uma e em lote (find_batch) e imprime a vazão
+// das duas formas; as frequências encontradas precisam ser as mesmas
+template <typename dicts>
+void report_queries(dicts &dict, const Options &opts, OutputBuffer &out)
+{
+    if constexpr (has_find_batch<dicts, std::string>::value)
+    {
+        std::vector<std::string> words;
+        stringstream file = LoadFile("./Textos/" + opts.queries);
+        string word;
+        while (file >> word)
+            words.push_back(word);
+
+        std::vector<int> single(words.size()), batch(words.size());
+        size_t found = 0;
+        size_t rejected = dict.bloom_rejections();
+        auto start = high_resolution_clock::now();
+        for (size_t i = 0; i < words.size(); i++)
+        {
+            single[i] = dict.find(words[i]);
+            found += single[i] != 0;
+        }
+        duration<double, std::milli> one = high_resolution_clock::now() - start;
+        rejected = dict.bloom_rejections() - rejected;
+
+        start = high_resolution_clock::now();
+        dict.find_batch(words.data(), words.size(), batch.data());
+        duration<double, std::milli> many = high_resolution_clock::now() - start;
+
+        out << "Consultas (" << opts.queries << "): " << words.size() << " palavras, " << found << " encontradas";
+        if (dict.bloom_filter() != nullptr)
+            out << ", " << rejected << " barradas pelo filtro de Bloom";
+        out << '\n';
+        out << "Buscas uma a uma: " << one.count() << "ms (" << static_cast<size_t>(words.size() / std::max(one.count(), 1e-6) * 1000)
+            << " buscas/s), em lote: " << many.count() << "ms ("
+            << static_cast<size_t>(words.size() / std::max(many.count(), 1e-6) * 1000) << " buscas/s)" << '\n';
+        if (single != batch)
+            cerr << "Error: batch lookups differ from single lookups" << endl;
+    }
+}
+
+// função que imprime a lista de palavras (todas em ordem, ou só as mais frequentes com --top)
+template <typename dicts>
+void print_list(dicts &dict, const Options &opts, OutputBuffer &out)
+{
+    if (opts.top > 0)
+    {
+        // Apenas as mais frequentes: seleção com heap limitado, sem a ordenação alfabética completa
+        out << "Palavras mais frequentes (top " << opts.top << "): " << '\n'
+            << '\n';
+        for (const auto &p : dict.top_k(opts.top))
+            out.entry(p.first, p.second);
+        return;
+    }
+    out << "Lista de palavras: " << '\n'
+        << '\n';
+    dict.print(out);
+}
+
+// função que imprime o cabeçalho com as estatísticas da execução e a lista de palavras
+// Com timings, a lista é gerada antes do cabeçalho (em memória) para que o tempo dela apareça nele
+template <typename dicts>
+void report(dicts &dict, string filename, milliseconds duration, const Options &opts, const HyperLogLog *hll = nullptr,
+            PhaseTimings *timings = nullptr, const LatencyRecorder *latency = nullptr, const SnapshotReads *reads = nullptr)
+{
+    std::ostringstream list;
+    if (timings != nullptr)
+    {
+        ScopedTimer timer(timings, Phase::Output);
+        OutputBuffer listOut(list);
+        print_list(dict, opts, listOut);
+    }
+
+    // Cabeçalho e lista vão pelo mesmo buffer de saída (poucas escritas grandes, sem flush por linha)
+    OutputBuffer out(cout);
+    out << "Estrutura de Dados: " << TypeName(typeid(dict).name()) << '\n';
+    out << "Nome do arquivo: " << filename << '\n';
+    out << "Numero de palavras: " << dict.size() << '\n';
+    if (hll != nullptr)
+        out << "Numero de palavras estimado (HyperLogLog): " << hll->estimate() << " (erro padrão "
+            << 100 * hll->standard_error() << "%, " << hll->bytes() << " bytes)" << '\n';
+    if (opts.count)
+        out << "Numero de Comparações: " << dict.comparisons() << '\n';
+    else
+        out << "Numero de Comparações: não contadas (--no-count)" << '\n';
+    if (timings != nullptr && timings->perf() != nullptr)
+        report_counters(*timings, out);
+    out << "Tempo de execução: " << duration.count() << "ms" << '\n';
+    if (latency != nullptr)
+        report_latency(*latency, out);
+    if constexpr (has_memory<dicts>::value)
+        dict.memory().print(out, dict.size());
+    report_bloom(dict, out);
+    report_extra(dict, out);
+    if (reads != nullptr)
+        report_reads(*reads, out);
+    if (opts.freeze)
+        report_freeze(dict, opts, out);
+    if (!opts.queries.empty())
+        report_queries(dict, opts, out);
+    if (opts.stats)
+        report_stats(dict, out);
+    if (timings != nullptr)
+    {
+        if (opts.timings)
+            report_timings(*timings, out);
+        out << list.str();
+        return;
+    }
+    print_list(dict, opts, out);
+}
+
 // função que executa a estrutura de dados
+// Com timings, o texto é dividido em palavras antes da inserção, para medir as duas fases separadamente
+// Com --latency, cada inserção (ou uma amostra delas) é cronometrada individualmente
 template <typename dicts>
-void run(dicts &dict, string filename)
+void run(dicts &dict, string filename, const Options &opts, PhaseTimings *timings = nullptr)
 {
+    LatencyRecorder recorder(opts.latency);
+    LatencyRecorder *latency = opts.latency > 0 ? &recorder : nullptr;
+
     // Inicia a contagem do tempo
     auto start = high_resolution_clock::now();
 
     // Lê o arquivo e insere as palavras no dicionário
-    stringstream file = LoadFile("./Textos/" + filename);
+    stringstream file = LoadFile("./Textos/" + filename, timings);
 
     std::string word;
-    while (file >> word)
+    std::vector<std::string> words;
+    if (timings != nullptr)
     {
-        dict.add(icu::UnicodeString::fromUTF8(
-            icu::StringPiece(word.c_str(), word.size())));
+        ScopedTimer timer(timings, Phase::Tokenize);
+        while (file >> word)
+        {
+            words.push_back(std::move(word));
+        }
+        timings->add_tokens(words.size());
     }
 
+    // Passada opcional que estima o vocabulário e pré-dimensiona a estrutura (evita os rehash por dobra)
+    // A passada tem a sua própria fase; só o pré-dimensionamento entra na inserção
+    HyperLogLog hll(opts.hll > 0 ? opts.hll : 4);
+    if (opts.hll > 0)
+    {
+        {
+            ScopedTimer timer(timings, Phase::Estimate);
+            for (const std::string &w : words)
+            {
+                hll.add(w);
+            }
+            while (file >> word)
+            {
+                hll.add(word);
+            }
+            if (timings == nullptr)
+            {
+                file.clear();
+                file.seekg(0);
+            }
+        }
+        ScopedTimer timer(timings, Phase::Insert);
+        if constexpr (has_reserve<dicts>::value)
+            dict.reserve(hll.estimate());
+    }
+
+    // Filtro de Bloom mantido durante a inserção (dimensionado pela estimativa, se houver)
+    enable_bloom(dict, opts, opts.hll > 0 ? hll.estimate() : 0);
+
+    // Com --reader (estruturas com snapshot), uma thread lê versões do dicionário enquanto as palavras são
+    // inseridas; o trabalho dela entra no tempo, na latência e nos contadores da inserção
+    std::unique_ptr<SnapshotReader<dicts>> reader;
+    if constexpr (has_snapshot<dicts>::value)
+    {
+        if (opts.reader)
+            reader.reset(new SnapshotReader<dicts>(dict));
+    }
+
+    {
+        ScopedTimer timer(timings, Phase::Insert);
+        for (const std::string &w : words)
+        {
+            ScopedLatency op(latency, LatencyOp::Add);
+            dict.add(w);
+        }
+        while (file >> word)
+        {
+            ScopedLatency op(latency, LatencyOp::Add);
+            dict.add(word);
+        }
+    }
+    SnapshotReads reads;
+    if (reader)
+        reads = reader->stop();
+
     // Finaliza a contagem do tempo e calcula a duração
     auto stop = high_resolution_clock::now();
     auto duration = duration_cast<milliseconds>(stop - start);
 
     // Imprime o tempo de execução
-    cout << "Estrutura de Dados: " << TypeName(typeid(dict).name()) << endl;
-    cout << "Nome do arquivo: " << filename << endl;
-    cout << "Numero de palavras: " << dict.size() << endl;
-    cout << "Numero de Comparações: " << dict.comparisons() << endl;
-    cout << "Tempo de execução: " << duration.count() << "ms" << endl;
-    cout << "Lista de palavras: " << endl
-         << endl;
-    dict.print();
+    report(dict, filename, duration, opts, opts.hll > 0 ? &hll : nullptr, timings, latency, reader ? &reads : nullptr);
+}
+
+// função que executa a estrutura de dados com várias threads inserindo ao mesmo tempo
+// (somente para estruturas seguras entre threads)
+// Com timings, a tokenização e a inserção (feitas juntas em cada thread) são somadas na fase de inserção
+template <typename dicts>
+void run_concurrent(dicts &dict, string filename, const Options &opts, PhaseTimings *timings = nullptr)
+{
+    // Inicia a contagem do tempo
+    auto start = high_resolution_clock::now();
+
+    // Lê o arquivo e divide o texto em um pedaço por thread, sempre em um espaço
+    std::string text = LoadFile("./Textos/" + filename, timings).str();
+    unsigned int nthreads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<size_t> bounds = {0};
+    for (unsigned int t = 1; t < nthreads; t++)
+    {
+        size_t pos = std::max(bounds.back(), text.size() * t / nthreads);
+        while (pos < text.size() && !isspace((unsigned char)text[pos]))
+            pos++;
+        bounds.push_back(pos);
+    }
+    bounds.push_back(text.size());
+
+    // Cada thread tokeniza o seu pedaço e insere as palavras no mesmo dicionário
+    // Com --latency, cada thread mede as suas inserções e os histogramas são somados no final
+    std::vector<LatencyRecorder> recorders;
+    {
+        ScopedTimer timer(timings, Phase::Insert);
+        std::vector<std::thread> threads;
+        std::atomic<size_t> tokens{0};
+        for (unsigned int t = 0; t < nthreads; t++)
+        {
+            if (opts.latency > 0)
+                recorders.emplace_back(opts.latency, t + 1);
+        }
+        for (unsigned int t = 0; t < nthreads; t++)
+        {
+            LatencyRecorder *latency = opts.latency > 0 ? &recorders[t] : nullptr;
+            threads.emplace_back([&dict, &text, &bounds, &tokens, t, latency]()
+                                 {
+                stringstream chunk(text.substr(bounds[t], bounds[t + 1] - bounds[t]));
+                std::string word;
+                size_t n = 0;
+                while (chunk >> word)
+                {
+                    ScopedLatency op(latency, LatencyOp::Add);
+                    dict.add(word);
+                    n++;
+                }
+                tokens.fetch_add(n, std::memory_order_relaxed); });
+        }
+        for (auto &th : threads)
+            th.join();
+        if (timings != nullptr)
+            timings->add_tokens(tokens.load());
+    }
+
+    // O filtro de Bloom não aceita inserções simultâneas: é criado depois, com todas as palavras
+    enable_bloom(dict, opts);
+
+    // Finaliza a contagem do tempo e calcula a duração
+    auto stop = high_resolution_clock::now();
+    auto duration = duration_cast<milliseconds>(stop - start);
+
+    // Imprime o tempo de execução
+    LatencyRecorder latency(opts.latency);
+    for (const LatencyRecorder &r : recorders)
+        latency.merge(r);
+    report(dict, filename, duration, opts, nullptr, timings, opts.latency > 0 ? &latency : nullptr);
+}
+
+// função que preenche a estrutura a partir de um snapshot binário (--load), sem ler nem tokenizar o texto
+// O tempo de abrir o snapshot entra na fase de leitura e o de inserir as palavras na de inserção
+template <typename dicts>
+void run_snapshot(dicts &dict, string filename, const Options &opts, PhaseTimings *timings = nullptr)
+{
+    // Inicia a contagem do tempo
+    auto start = high_resolution_clock::now();
+
+    std::unique_ptr<Snapshot> snapshot;
+    {
+        ScopedTimer timer(timings, Phase::Read);
+        try
+        {
+            snapshot.reset(new Snapshot(opts.load));
+        }
+        catch (std::runtime_error &e)
+        {
+            cerr << "Error: " << e.what() << endl;
+            exit(EXIT_FAILURE); // Sai do programa, como na falha de abertura do texto
+        }
+    }
+    enable_bloom(dict, opts, snapshot->size());
+    {
+        ScopedTimer timer(timings, Phase::Insert);
+        dict.load(*snapshot);
+    }
+    if (timings != nullptr)
+        timings->add_tokens(snapshot->size());
+
+    // Finaliza a contagem do tempo e calcula a duração
+    auto stop = high_resolution_clock::now();
+    auto duration = duration_cast<milliseconds>(stop - start);
+
+    report(dict, filename, duration, opts, nullptr, timings);
+}
+
+// função que apenas estima o número de palavras distintas do arquivo (HyperLogLog), sem guardar as palavras
+void run_estimate(string filename, const Options &opts, PhaseTimings *timings = nullptr)
+{
+    // Inicia a contagem do tempo
+    auto start = high_resolution_clock::now();
+
+    stringstream file = LoadFile("./Textos/" + filename, timings);
+
+    HyperLogLog hll(opts.hll > 0 ? opts.hll : 12);
+    size_t tokens = 0;
+    {
+        ScopedTimer timer(timings, Phase::Insert);
+        std::string word;
+        while (file >> word)
+        {
+            hll.add(word);
+            tokens++;
+        }
+    }
+    if (timings != nullptr)
+        timings->add_tokens(tokens);
+
+    // Finaliza a contagem do tempo e calcula a duração
+    auto stop = high_resolution_clock::now();
+    auto duration = duration_cast<milliseconds>(stop - start);
+
+    OutputBuffer out(cout);
+    out << "Estrutura de Dados: " << TypeName(typeid(hll).name()) << '\n';
+    out << "Nome do arquivo: " << filename << '\n';
+    out << "Numero de palavras estimado: " << hll.estimate() << " (erro padrão " << 100 * hll.standard_error() << "%)" << '\n';
+    out << "Total de ocorrências: " << tokens << '\n';
+    if (timings != nullptr && timings->perf() != nullptr)
+        report_counters(*timings, out);
+    out << "Memória usada: " << hll.bytes() << " bytes" << '\n';
+    out << "Tempo de execução: " << duration.count() << "ms" << '\n';
+    if (opts.timings)
+        report_timings(*timings, out);
+}
+
+// função que cria o dicionário da estrutura escolhida e chama fn com ele
+// D é o tipo de dicionário (Dict, IdDict ou SpillDict), Value o tipo de valor guardado na estrutura
+// e Stats a política de instrumentação da estrutura (CountingStats ou NoStats)
+template <template <typename> class D, typename Value, typename Stats, typename F>
+bool with_engine(int mode, F fn)
+{
+    if (mode == 1) // AVL
+    {
+        D<AVLTree<WordRef, Value, u_comparator, Stats>> dict;
+        fn(dict);
+    }
+    else if (mode == 2) // RB
+    {
+        D<RBTree<WordRef, Value, u_comparator, Stats>> dict;
+        fn(dict);
+    }
+    else if (mode == 3) // Hash2
+    {
+        D<Hash2Table<WordRef, Value, u_comparator, std::hash<WordRef>, Stats>> dict;
+        fn(dict);
+    }
+    else if (mode == 4) // Hash
+    {
+        D<HashTable<WordRef, Value, u_comparator, std::hash<WordRef>, Stats>> dict;
+        fn(dict);
+    }
+    else if (mode == 5) // Treap
+    {
+        D<Treap<WordRef, Value, u_comparator, Stats>> dict;
+        fn(dict);
+    }
+    else if (mode == 6) // SkipList
+    {
+        D<SkipList<WordRef, Value, u_comparator, Stats>> dict;
+        fn(dict);
+    }
+    else if (mode == 7) // AVL persistente
+    {
+        D<PersistentAVLTree<WordRef, Value, u_comparator, Stats>> dict;
+        fn(dict);
+    }
+    else
+        return false;
+    return true;
+}
+
+// função que escolhe a política de instrumentação e chama with_engine
+// Com --no-count a estrutura é compilada com NoStats: nenhum contador nos laços de busca
+template <template <typename> class D, typename Value, typename F>
+bool with_policy(int mode, const Options &opts, F fn)
+{
+    if (opts.count)
+        return with_engine<D, Value, CountingStats>(mode, fn);
+    return with_engine<D, Value, NoStats>(mode, fn);
+}
+
+// função que preenche várias estruturas com o mesmo texto (modos separados por vírgula, como "1,2,3,4")
+// O texto é lido, normalizado e dividido em palavras uma única vez, em um TokenBuffer, e as palavras são
+// repetidas em cada estrutura (com --parallel, uma thread por estrutura). Cada estrutura grava a sua saída
+// como na execução de um modo só, mas o tempo de execução dela é só o da inserção, para que as estruturas
+// possam ser comparadas; o tempo da preparação compartilhada é impresso no console
+int run_multi(const std::vector<int> &modes, const string &filename, const Options &opts)
+{
+    namespace fs = std::filesystem;
+    std::string dirPath = "./output/" + filename.substr(0, filename.size() - 4) + "/";
+    if (!fs::exists(dirPath))
+        fs::create_directories(dirPath);
+
+    // Fases compartilhadas (leitura, decodificação, normalização e tokenização), copiadas para cada estrutura
+    PhaseTimings shared;
+    std::unique_ptr<PerfCounters> perf;
+    if (opts.perf)
+    {
+        perf.reset(new PerfCounters());
+        shared.attach(perf.get());
+    }
+    bool timed = opts.timings || opts.perf;
+
+    auto start = high_resolution_clock::now();
+    TokenBuffer tokens;
+    {
+        stringstream file = LoadFile("./Textos/" + filename, &shared);
+        ScopedTimer timer(&shared, Phase::Tokenize);
+        tokens = TokenBuffer::tokenize(file);
+    }
+    auto prepared = duration_cast<milliseconds>(high_resolution_clock::now() - start);
+
+    std::vector<milliseconds> durations(modes.size());
+    std::vector<std::string> names(modes.size());
+    std::vector<char> failed(modes.size(), 0);
+    std::mutex output; // Uma estrutura por vez grava a saída (cout é redirecionado para o arquivo dela)
+
+    auto fill = [&](size_t e)
+    {
+        std::string outPath = dirPath + std::to_string(modes[e]) + '-' + filename;
+        std::string basePath = outPath.substr(0, outPath.size() - 4);
+        Options engineOpts = opts;
+        if (opts.save)
+            engineOpts.save_path = basePath + ".snap";
+        PhaseTimings timings = shared;
+        with_policy<Dict, int>(modes[e], engineOpts, [&](auto &dict)
+                               {
+            LatencyRecorder recorder(opts.latency);
+            LatencyRecorder *latency = opts.latency > 0 ? &recorder : nullptr;
+            enable_bloom(dict, opts);
+
+            auto begin = high_resolution_clock::now();
+            {
+                ScopedTimer timer(timed ? &timings : nullptr, Phase::Insert);
+                for (size_t i = 0; i < tokens.size(); i++)
+                {
+                    ScopedLatency op(latency, LatencyOp::Add);
+                    dict.add(tokens[i]);
+                }
+            }
+            durations[e] = duration_cast<milliseconds>(high_resolution_clock::now() - begin);
+            timings.add_tokens(tokens.size());
+            names[e] = TypeName(typeid(dict).name());
+
+            std::lock_guard<std::mutex> guard(output);
+            std::ofstream out(outPath);
+            if (!out)
+            {
+                cerr << "Error opening output file" << endl;
+                failed[e] = 1;
+                return;
+            }
+            streambuf *coutbuf = cout.rdbuf(out.rdbuf());
+            report(dict, filename, durations[e], engineOpts, nullptr, timed ? &timings : nullptr, latency);
+            cout.rdbuf(coutbuf);
+            if (opts.stats)
+                save_stats(dict, basePath + ".stats.json");
+            if (opts.save && !opts.freeze && !dict.save(engineOpts.save_path))
+                cerr << "Error writing snapshot" << endl;
+            if (timed)
+            {
+                std::ofstream json(basePath + ".timings.json");
+                timings.write_json(json);
+            } });
+    };
+
+    if (opts.parallel)
+    {
+        std::vector<std::thread> threads;
+        for (size_t e = 0; e < modes.size(); e++)
+            threads.emplace_back(fill, e);
+        for (auto &th : threads)
+            th.join();
+    }
+    else
+    {
+        for (size_t e = 0; e < modes.size(); e++)
+            fill(e);
+    }
+
+    cout << "Texto: " << filename << ", " << tokens.size() << " palavras, lidas e divididas uma vez em "
+         << prepared.count() << "ms (buffer de " << tokens.bytes() << " bytes)" << endl;
+    for (size_t e = 0; e < modes.size(); e++)
+        cout << modes[e] << " - " << names[e] << ": inserção em " << durations[e].count() << "ms" << endl;
+    for (char f : failed)
+    {
+        if (f)
+            return 1;
+    }
+    return 0;
+}
+
+// função que lê a lista de modos separados por vírgula ("1,2,3,4"); retorna false se algum for inválido
+// Só as estruturas exatas (1-7), sem repetição (cada uma grava um arquivo)
+bool parse_modes(const std::string &arg, std::vector<int> &modes)
+{
+    std::stringstream list(arg);
+    std::string item;
+    while (std::getline(list, item, ','))
+    {
+        int mode;
+        try
+        {
+            size_t used;
+            mode = std::stoi(item, &used);
+            if (used != item.size())
+                return false;
+        }
+        catch (std::exception &e)
+        {
+            return false;
+        }
+        if (mode < 1 || mode > 7 || std::find(modes.begin(), modes.end(), mode) != modes.end())
+            return false;
+        modes.push_back(mode);
+    }
+    return !modes.empty();
 }
 
 int main(int argc, char *argv[])
 {
+    Options opts;
+
     // Verifica se o número de argumentos está correto
-    if (argc != 3)
+    if (argc < 3 || !ParseOptions(argc, argv, opts))
     {
         cerr << "Invalid Arguments, open Readme.txt" << endl;
         return 1;
     }
 
+    // Vários modos de uma vez: o texto é dividido uma única vez e repetido em cada estrutura
+    if (std::string(argv[1]).find(',') != std::string::npos)
+    {
+        std::vector<int> modes;
+        if (!parse_modes(argv[1], modes) || opts.ids || opts.spill > 0 || !opts.load.empty() || opts.hll > 0 ||
+            !opts.save_path.empty() || opts.reader || (opts.parallel && opts.perf))
+        {
+            cerr << "Invalid Arguments, open Readme.txt" << endl;
+            return 1;
+        }
+        return run_multi(modes, argv[2], opts);
+    }
+    if (opts.parallel)
+    {
+        cerr << "Invalid Arguments, open Readme.txt" << endl; // --parallel só com vários modos
+        return 1;
+    }
+
     namespace fs = std::filesystem;
 
     std::string dirPath = "./output/" + std::string(argv[2]).substr(0, std::string(argv[2]).size() - 4) + "/";
@@ -70,7 +807,8 @@ int main(int argc, char *argv[])
     }
 
     // Abre o arquivo de saída
-    std::ofstream out(dirPath + std::string(argv[1]) + '-' + std::string(argv[2]));
+    std::string outPath = dirPath + std::string(argv[1]) + '-' + std::string(argv[2]);
+    std::ofstream out(outPath);
 
     if (!out)
     {
@@ -88,36 +826,96 @@ int main(int argc, char *argv[])
     // Define o nome do arquivo
     string filename = argv[2];
 
-    // Verifica se a estrutura fornecida é válida
-    if (mode == 1) // AVL
+    // Caminho base dos arquivos auxiliares (saída sem a extensão .txt)
+    std::string basePath = outPath.substr(0, outPath.size() - 4);
+
+    // Tempos por fase (--timings) e contadores de hardware por fase (--perf); nulo desliga a medição
+    PhaseTimings phaseTimings;
+    PhaseTimings *timings = opts.timings || opts.perf ? &phaseTimings : nullptr;
+    std::unique_ptr<PerfCounters> perf;
+    if (opts.perf)
     {
-        Dict<AVLTree<UnicodeString, int, u_comparator>> dict;
-        run(dict, filename);
+        perf.reset(new PerfCounters());
+        phaseTimings.attach(perf.get());
     }
-    else if (mode == 2) // RB
+
+    // Snapshot gravado por --save (ao lado da saída, se o caminho não for dado)
+    if (opts.save && opts.save_path.empty())
+        opts.save_path = basePath + ".snap";
+
+    // Verifica se a estrutura fornecida é válida e executa
+    bool valid = true;
+    if ((opts.save || !opts.load.empty() || opts.freeze || !opts.queries.empty() || opts.bloom > 0) && (mode == 8 || mode == 9))
+        valid = false; // Snapshots, buscas em lote e filtro de Bloom só para as estruturas exatas
+    else if ((opts.spill > 0 || opts.ids) && (mode == 8 || mode == 9))
+        valid = false; // Spill em disco e IDs densos só para as estruturas exatas
+    else if (opts.hll > 0 && mode == 6 && opts.spill == 0 && !opts.ids)
+        valid = false; // As threads do modo 6 tokenizam e inserem juntas, sem a passada de estimativa
+    else if (opts.reader && mode != 7)
+        valid = false; // Só a AVL persistente tira snapshots
+    else if (mode == 9)
     {
-        Dict<RBTree<UnicodeString, int, u_comparator>> dict;
-        run(dict, filename);
+        // Apenas a estimativa do vocabulário, com alguns KB de memória
+        run_estimate(filename, opts, timings);
     }
-    else if (mode == 3) // Hash2
+    else if (mode == 8)
     {
-        Dict<Hash2Table<UnicodeString, int, u_comparator>> dict;
-        run(dict, filename);
+        // Contagem aproximada com memória limitada (o número de palavras também é estimado)
+        ApproxDict<u_comparator> dict(opts.eps, opts.delta, opts.heavy);
+        run(dict, filename, opts, timings);
     }
-    else if (mode == 4) // Hash
+    else if (opts.spill > 0)
+    {
+        // Estrutura limitada a opts.spill MB; o excedente vai para runs ordenados em disco
+        valid = with_policy<SpillDict, int>(mode, opts, [&](auto &dict)
+                                                  {
+            dict.budget(opts.spill << 20);
+            run(dict, filename, opts, timings); });
+    }
+    else if (opts.ids)
     {
-        Dict<HashTable<UnicodeString, int, u_comparator>> dict;
-        run(dict, filename);
+        // A estrutura serve apenas de índice palavra -> ID; grava também a sequência de IDs e o vocabulário
+        valid = with_policy<IdDict, uint32_t>(mode, opts, [&](auto &dict)
+                                                    {
+            dict.record_tokens(true);
+            run(dict, filename, opts, timings);
+            if (opts.stats)
+                save_stats(dict, basePath + ".stats.json");
+            dict.save_tokens(basePath + ".ids");
+            dict.save_vocab(basePath + ".vocab"); });
     }
     else
     {
-        cerr << "Invalid Arguments, open Readme.txt" << endl;
-        return 1;
+        valid = with_policy<Dict, int>(mode, opts, [&](auto &dict)
+                                             {
+            if (!opts.load.empty()) // Palavras e frequências de um snapshot, sem o texto
+                run_snapshot(dict, filename, opts, timings);
+            else if (mode == 6) // SkipList (inserção com várias threads)
+                run_concurrent(dict, filename, opts, timings);
+            else
+                run(dict, filename, opts, timings);
+            if (opts.stats)
+                save_stats(dict, basePath + ".stats.json");
+            if (opts.save && !opts.freeze && !dict.save(opts.save_path))
+                cerr << "Error writing snapshot" << endl; });
     }
 
     // Restaura o buffer original do cout
     cout.rdbuf(coutbuf);
 
+    // Grava os tempos (e os contadores) por fase ao lado da saída
+    if (valid && timings != nullptr)
+    {
+        std::ofstream json(basePath + ".timings.json");
+        timings->write_json(json);
+    }
+
+    if (!valid)
+    {
+        cerr << "Invalid Arguments, open Readme.txt" << endl;
+        return 1;
+    }
+
     return 0;
 }
 
@@ -0,0 +1,379 @@
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+#include "./EDs/Dict.h"
+#include "./EDs/QueryProtocol.h"
+#include "./functions.cpp"
+
+using namespace std;
+using namespace std::chrono;
+
+// Servidor de consultas: monta o dicionário uma única vez (a partir de um texto de ./Textos ou de um
+// snapshot) e responde find/contains/top_k/prefix pelo protocolo de QueryProtocol.h em um socket Unix.
+// Depois da montagem o dicionário é congelado (FrozenDict), então as consultas usam o hash perfeito
+// e a árvore de Eytzinger. Uma única thread atende todas as conexões com epoll: cada conexão acumula
+// os bytes recebidos, responde todos os pedidos completos na ordem (pipelining) e envia as respostas
+// quando o socket aceita; se o cliente não lê as respostas, o servidor para de ler os pedidos dele
+
+// Opções do servidor
+struct ServerOptions
+{
+    string socket = "./output/dict.sock"; // --socket=CAMINHO: socket Unix onde o servidor escuta
+    int mode = 3;                         // --mode=N: estrutura usada para montar o dicionário (1-7, como no main)
+    string text;                          // Arquivo de ./Textos com as palavras
+    string load;                          // --load=CAMINHO: snapshot (congelado ou não) no lugar do texto
+    size_t max_output = 8 << 20;          // Respostas pendentes de uma conexão a partir das quais ela não é mais lida
+};
+
+typedef FrozenDict<u_comparator> Frozen;
+
+// Monta o dicionário com a estrutura D a partir das palavras do texto e congela
+template <typename D>
+unique_ptr<Frozen> Build(const string &text)
+{
+    D dict;
+    stringstream file = LoadFile("./Textos/" + text);
+    string word;
+    while (file >> word)
+        dict.add(word);
+    return unique_ptr<Frozen>(new Frozen(dict.freeze()));
+}
+
+// Monta o dicionário com a estrutura de número mode (mesma numeração do main); nulo se o número for inválido
+unique_ptr<Frozen> BuildEngine(int mode, const string &text)
+{
+    if (mode == 1)
+        return Build<Dict<AVLTree<WordRef, int, u_comparator>>>(text);
+    else if (mode == 2)
+        return Build<Dict<RBTree<WordRef, int, u_comparator>>>(text);
+    else if (mode == 3)
+        return Build<Dict<Hash2Table<WordRef, int, u_comparator>>>(text);
+    else if (mode == 4)
+        return Build<Dict<HashTable<WordRef, int, u_comparator>>>(text);
+    else if (mode == 5)
+        return Build<Dict<Treap<WordRef, int, u_comparator>>>(text);
+    else if (mode == 6)
+        return Build<Dict<SkipList<WordRef, int, u_comparator>>>(text);
+    else if (mode == 7)
+        return Build<Dict<PersistentAVLTree<WordRef, int, u_comparator>>>(text);
+    return nullptr;
+}
+
+// Abre um snapshot: o congelado é só mapeado; o comum passa por uma tabela de hash e é congelado
+unique_ptr<Frozen> LoadSnapshot(const string &path)
+{
+    {
+        Snapshot snapshot(path);
+        if (!snapshot.frozen())
+        {
+            Dict<Hash2Table<WordRef, int, u_comparator>> dict;
+            dict.load(snapshot);
+            return unique_ptr<Frozen>(new Frozen(dict.freeze()));
+        }
+    }
+    return unique_ptr<Frozen>(new Frozen(path));
+}
+
+// Responde um pedido, acrescentando a resposta ao buffer de saída
+// top tem as palavras em ordem decrescente de frequência (calculada uma vez)
+void Answer(const Frozen &dict, const vector<pair<string_view, uint32_t>> &top, const QueryRequest &req, string &out)
+{
+    switch (req.op)
+    {
+    case QueryOp::Find:
+        encode_response(out, QueryStatus::Ok, dict.find(req.word));
+        break;
+    case QueryOp::Contains:
+        encode_response(out, QueryStatus::Ok, dict.contains(req.word) ? 1 : 0);
+        break;
+    case QueryOp::TopK:
+        encode_response(out, vector<pair<string_view, uint32_t>>(top.begin(), top.begin() + min<size_t>(req.arg, top.size())));
+        break;
+    case QueryOp::Prefix:
+        encode_response(out, dict.prefix(req.word, req.arg));
+        break;
+    default:
+        encode_response(out, QueryStatus::BadRequest, 0);
+    }
+}
+
+#ifdef __linux__
+volatile sig_atomic_t g_stop = 0; // Pedido de parada (SIGINT, SIGTERM)
+
+void Stop(int)
+{
+    g_stop = 1;
+}
+
+// Estado de uma conexão
+struct Connection
+{
+    int fd;
+    FrameReader in;  // Bytes recebidos
+    string out;      // Respostas ainda não enviadas (a partir de sent)
+    size_t sent = 0;
+    uint32_t events = 0; // Eventos registrados no epoll
+    bool closed = false; // O cliente fechou ou mandou um quadro inválido
+
+    size_t pending() const
+    {
+        return out.size() - sent;
+    }
+};
+
+// Responde os pedidos completos da conexão, enquanto as respostas pendentes couberem no limite
+size_t Process(Connection &c, const Frozen &dict, const vector<pair<string_view, uint32_t>> &top, const ServerOptions &opts)
+{
+    size_t answered = 0;
+    string_view body;
+    int status;
+    while (c.pending() < opts.max_output && (status = c.in.next(body)) != 0)
+    {
+        QueryRequest req;
+        if (status < 0)
+        {
+            c.closed = true; // Quadro maior que o permitido: o fluxo não pode mais ser interpretado
+            break;
+        }
+        if (decode_request(body, req))
+            Answer(dict, top, req, c.out);
+        else
+            encode_response(c.out, QueryStatus::BadRequest, 0);
+        answered++;
+    }
+    c.in.compact();
+    return answered;
+}
+
+// Envia o que o socket aceitar das respostas pendentes
+void Flush(Connection &c)
+{
+    while (c.pending() > 0)
+    {
+        ssize_t n = send(c.fd, c.out.data() + c.sent, c.pending(), MSG_NOSIGNAL);
+        if (n < 0)
+        {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+                c.closed = true;
+            if (errno != EINTR)
+                break;
+            continue;
+        }
+        c.sent += static_cast<size_t>(n);
+    }
+    if (c.pending() == 0)
+    {
+        c.out.clear();
+        c.sent = 0;
+    }
+}
+
+// Laço de eventos; retorna o código de saída do programa
+int Serve(const Frozen &dict, const ServerOptions &opts)
+{
+    vector<pair<string_view, uint32_t>> top = dict.top_k(dict.size());
+
+    int listener = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (listener < 0 || opts.socket.size() >= sizeof(addr.sun_path))
+    {
+        cerr << "Error creating socket " << opts.socket << endl;
+        return 1;
+    }
+    strncpy(addr.sun_path, opts.socket.c_str(), sizeof(addr.sun_path) - 1);
+    unlink(opts.socket.c_str());
+    if (bind(listener, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0 || listen(listener, 128) < 0)
+    {
+        cerr << "Error binding socket " << opts.socket << ": " << strerror(errno) << endl;
+        close(listener);
+        return 1;
+    }
+
+    int epfd = epoll_create1(EPOLL_CLOEXEC);
+    epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = listener;
+    epoll_ctl(epfd, EPOLL_CTL_ADD, listener, &ev);
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = Stop;
+    sigaction(SIGINT, &sa, nullptr);
+    sigaction(SIGTERM, &sa, nullptr);
+
+    printf("Escutando em %s\n", opts.socket.c_str());
+    fflush(stdout);
+
+    unordered_map<int, unique_ptr<Connection>> connections;
+    size_t accepted = 0, requests = 0;
+    vector<char> buffer(1 << 16);
+    epoll_event events[64];
+    while (!g_stop)
+    {
+        int ready = epoll_wait(epfd, events, 64, 1000);
+        if (ready < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            cerr << "epoll_wait: " << strerror(errno) << endl;
+            break;
+        }
+        for (int e = 0; e < ready; e++)
+        {
+            int fd = events[e].data.fd;
+            if (fd == listener)
+            {
+                int client;
+                while ((client = accept4(listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0)
+                {
+                    unique_ptr<Connection> c(new Connection());
+                    c->fd = client;
+                    c->events = EPOLLIN;
+                    ev.events = c->events;
+                    ev.data.fd = client;
+                    epoll_ctl(epfd, EPOLL_CTL_ADD, client, &ev);
+                    connections[client] = std::move(c);
+                    accepted++;
+                }
+                continue;
+            }
+
+            auto it = connections.find(fd);
+            if (it == connections.end())
+                continue;
+            Connection &c = *it->second;
+            if (events[e].events & EPOLLIN)
+            {
+                while (c.pending() < opts.max_output)
+                {
+                    ssize_t n = recv(fd, buffer.data(), buffer.size(), 0);
+                    if (n > 0)
+                    {
+                        c.in.feed(buffer.data(), static_cast<size_t>(n));
+                        requests += Process(c, dict, top, opts);
+                        continue;
+                    }
+                    if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+                        c.closed = true;
+                    if (n == 0 || errno != EINTR)
+                        break;
+                }
+            }
+            if (events[e].events & (EPOLLERR | EPOLLHUP))
+                c.closed = true;
+
+            // Envia as respostas; o espaço liberado no limite permite responder os pedidos que esperavam
+            size_t answered;
+            do
+            {
+                Flush(c);
+                answered = c.closed ? 0 : Process(c, dict, top, opts);
+                requests += answered;
+            } while (answered > 0);
+
+            if (c.closed)
+            {
+                epoll_ctl(epfd, EPOLL_CTL_DEL, fd, nullptr);
+                close(fd);
+                connections.erase(it);
+                continue;
+            }
+            // Escuta a escrita só com respostas pendentes e a leitura só abaixo do limite
+            uint32_t want = (c.pending() > 0 ? uint32_t(EPOLLOUT) : 0) | (c.pending() < opts.max_output ? uint32_t(EPOLLIN) : 0);
+            if (want != c.events)
+            {
+                c.events = want;
+                ev.events = want;
+                ev.data.fd = fd;
+                epoll_ctl(epfd, EPOLL_CTL_MOD, fd, &ev);
+            }
+        }
+    }
+
+    for (auto &entry : connections)
+        close(entry.first);
+    close(epfd);
+    close(listener);
+    unlink(opts.socket.c_str());
+    printf("Encerrado: %zu conexões, %zu pedidos respondidos\n", accepted, requests);
+    return 0;
+}
+#endif
+
+// Lê as opções da linha de comando; retorna false se alguma for inválida
+bool ParseServerOptions(int argc, char *argv[], ServerOptions &opts)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg.rfind("--socket=", 0) == 0 && arg.size() > 9)
+            opts.socket = arg.substr(9);
+        else if (arg.rfind("--load=", 0) == 0 && arg.size() > 7)
+            opts.load = arg.substr(7);
+        else if (arg.rfind("--mode=", 0) == 0)
+        {
+            try
+            {
+                opts.mode = stoi(arg.substr(7));
+            }
+            catch (exception &e)
+            {
+                return false;
+            }
+            if (opts.mode < 1 || opts.mode > 7)
+                return false;
+        }
+        else if (arg.rfind("--", 0) == 0 || !opts.text.empty())
+            return false;
+        else
+            opts.text = arg;
+    }
+    return opts.text.empty() != opts.load.empty(); // Um texto ou um snapshot
+}
+
+int main(int argc, char *argv[])
+{
+    ServerOptions opts;
+    if (!ParseServerOptions(argc, argv, opts))
+    {
+        cerr << "Invalid Arguments, open Readme.txt" << endl;
+        return 1;
+    }
+#ifdef __linux__
+    auto start = steady_clock::now();
+    unique_ptr<Frozen> dict;
+    try
+    {
+        dict = opts.load.empty() ? BuildEngine(opts.mode, opts.text) : LoadSnapshot(opts.load);
+    }
+    catch (exception &e)
+    {
+        cerr << "Error: " << e.what() << endl;
+        return 1;
+    }
+    auto stop = steady_clock::now();
+    printf("Dicionário pronto: %zu palavras, %zu bytes, %.1fms\n", dict->size(), dict->memory().total(),
+           duration<double, milli>(stop - start).count());
+    return Serve(*dict, opts);
+#else
+    cerr << "The server needs Linux (epoll and Unix sockets)" << endl;
+    return 1;
+#endif
+}